@@ -4,13 +4,16 @@
 #include "stm32f10x_adc.h"
 #include "delay.h"
 #include "lcd16x2.h"
-#include <stdio.h>
+#include "fmt.h"
+#include "swtimer.h"
 
 void ADC1_Init(void);
 uint16_t ADC1_Read(void);
+void adc_update(void* arg);
 
 uint16_t adcValue;
 char sAdcValue[5];
+swtimer_t adc_timer;
 
 int main(void)
 {
@@ -20,20 +23,30 @@ int main(void)
 	// Initialize ADC
 	ADC1_Init();
 	
+	// Read and display ADC value every 500 ms
+	swtimer_init();
+	swtimer_create(&adc_timer, adc_update, 0);
+	swtimer_start(&adc_timer, 0, 500);
+	
 	while (1)
 	{
-		// Read ADC value
-		adcValue = ADC1_Read();
-		// Convert ADC value to string
-		sprintf(sAdcValue, "%i", adcValue);
-		// Display ADC value to LCD
-		lcd16x2_clrscr();
-		lcd16x2_puts(sAdcValue);
-
-		DelayMs(500);
+		swtimer_process();
+		// Sleep until the next timer is due or an interrupt occurs
+		DelayIdle(swtimer_idle_ms());
 	}
 }
 
+void adc_update(void* arg)
+{
+	// Read ADC value
+	adcValue = ADC1_Read();
+	// Convert ADC value to string
+	sAdcValue[fmt_dec(sAdcValue, adcValue, 0, FMT_PAD_SPACE)] = '\0';
+	// Display ADC value to LCD
+	lcd16x2_clrscr();
+	lcd16x2_puts(sAdcValue);
+}
+
 void ADC1_Init()
 {
 	// Initialization struct
@@ -3,8 +3,12 @@
 #include "stm32f10x_gpio.h"
 #include "stm32f10x_tim.h"
 #include "delay.h"
+#include "swtimer.h"
 
 void PWM_Init(void);
+void toggleSpeed(void* arg);
+
+swtimer_t speedTimer;
 
 int main(void)
 {
@@ -13,15 +17,30 @@ int main(void)
 	// Initialize PWM
 	PWM_Init();
 	
+	// Toggle motor speed every 3 s
+	swtimer_init();
+	swtimer_create(&speedTimer, toggleSpeed, 0);
+	swtimer_start(&speedTimer, 0, 3000);
+	
 	while (1)
+	{
+		swtimer_process();
+		// Sleep until the next timer is due or an interrupt occurs
+		DelayIdle(swtimer_idle_ms());
+	}
+}
+
+void toggleSpeed(void* arg)
+{
+	if (TIM2->CCR1 != 7199)
 	{
 		// Set motor speed to 7199 (max)
 		TIM2->CCR1 = 7199;
-		DelayMs(3000);
-		
+	}
+	else
+	{
 		// Set motor speed to 3599 (half)
 		TIM2->CCR1 = 3599;
-		DelayMs(3000);
 	}
 }
 
@@ -0,0 +1,346 @@
+/**
+  ******************************************************************************
+  * @file		swtimer.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "swtimer.h"
+
+/** Private variables ------------------------------------------------------- */
+// Slot list heads, each slot is a circular list with the head as sentinel
+static swtimer_node_t wheel[SWTIMER_LEVELS][SWTIMER_SLOTS];
+// Next tick (ms) to be processed
+static uint32_t next_tick;
+
+/** Private function prototypes --------------------------------------------- */
+static void swtimer_list_init(swtimer_node_t* head);
+static void swtimer_list_add(swtimer_node_t* head, swtimer_node_t* node);
+static void swtimer_list_del(swtimer_node_t* node);
+static void swtimer_list_move(swtimer_node_t* from, swtimer_node_t* to);
+static void swtimer_insert(swtimer_t* timer);
+static uint8_t swtimer_cascade(uint8_t level);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize timer wheel. DelayInit() must be called first.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void swtimer_init()
+{
+	uint8_t level, slot;
+
+	for (level = 0; level < SWTIMER_LEVELS; level++)
+	{
+		for (slot = 0; slot < SWTIMER_SLOTS; slot++)
+		{
+			swtimer_list_init(&wheel[level][slot]);
+		}
+	}
+	next_tick = DelayGetMs() + 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Initialize a timer object
+  * @param	Pointer to timer object
+  * @param	Function called when the timer expires
+  * @param	Argument passed to the callback
+  * @retval	None
+  ******************************************************************************
+  */
+void swtimer_create(swtimer_t* timer, swtimer_callback_t callback, void* arg)
+{
+	timer->node.next = 0;
+	timer->node.prev = 0;
+	timer->period = 0;
+	timer->callback = callback;
+	timer->arg = arg;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start or restart a timer
+  * @param	Pointer to timer object
+  * @param	Time until the first expiry in ms
+  * @param	Reload period in ms (0 = one-shot)
+  * @retval	None
+  ******************************************************************************
+  */
+void swtimer_start(swtimer_t* timer, uint32_t timeout_ms, uint32_t period_ms)
+{
+	if (timer->node.next)
+	{
+		swtimer_list_del(&timer->node);
+	}
+	timer->expires = DelayGetMs() + timeout_ms;
+	timer->period = period_ms;
+	swtimer_insert(timer);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Stop a timer, safe to call when the timer is not running
+  * @param	Pointer to timer object
+  * @retval	None
+  ******************************************************************************
+  */
+void swtimer_stop(swtimer_t* timer)
+{
+	if (timer->node.next)
+	{
+		swtimer_list_del(&timer->node);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether a timer is running
+  * @param	Pointer to timer object
+  * @retval	1 if running, otherwise 0
+  ******************************************************************************
+  */
+uint8_t swtimer_is_active(swtimer_t* timer)
+{
+	return timer->node.next != 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Advance the wheel up to current time and run expired callbacks.
+  *					Call this from the main loop.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void swtimer_process()
+{
+	uint32_t now = DelayGetMs();
+	swtimer_node_t expired;
+
+	while ((int32_t)(now - next_tick) >= 0)
+	{
+		uint8_t index = next_tick & SWTIMER_SLOT_MASK;
+		uint8_t level;
+
+		// When a level wraps, move the timers of the next level down
+		for (level = 1; (index == 0) && (level < SWTIMER_LEVELS); level++)
+		{
+			index = swtimer_cascade(level);
+		}
+		index = next_tick & SWTIMER_SLOT_MASK;
+		next_tick++;
+
+		// Detach the slot first, callbacks may start timers in the same slot
+		swtimer_list_init(&expired);
+		swtimer_list_move(&wheel[0][index], &expired);
+		while (expired.next != &expired)
+		{
+			swtimer_t* timer = (swtimer_t*)expired.next;
+
+			swtimer_list_del(&timer->node);
+			if (timer->period)
+			{
+				// Reload from the expiry time, not from now
+				timer->expires += timer->period;
+				swtimer_insert(timer);
+			}
+			timer->callback(timer->arg);
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get how long the main loop may sleep before swtimer_process()
+  *					has work to do (a timer expiry or a cascade of a wheel level)
+  * @param	None
+  * @retval	Time in ms (0 = process now, SWTIMER_NO_TIMEOUT = no timers)
+  ******************************************************************************
+  */
+uint32_t swtimer_idle_ms()
+{
+	uint32_t now = DelayGetMs();
+	uint32_t best = SWTIMER_NO_TIMEOUT;
+	uint32_t tick;
+	uint8_t level, i;
+
+	if ((int32_t)(now - next_tick) >= 0)
+	{
+		return 0;
+	}
+
+	// Level 0: first non-empty slot from the next tick
+	for (i = 0; i < SWTIMER_SLOTS; i++)
+	{
+		swtimer_node_t* slot;
+
+		tick = next_tick + i;
+		slot = &wheel[0][tick & SWTIMER_SLOT_MASK];
+		if (slot->next != slot)
+		{
+			best = tick - now;
+			break;
+		}
+	}
+
+	// Upper levels: first cascade that moves a non-empty slot down
+	for (level = 1; level < SWTIMER_LEVELS; level++)
+	{
+		uint8_t shift = SWTIMER_SLOT_BITS * level;
+		uint32_t step = 1UL << shift;
+
+		// First tick at or after next_tick where this level cascades
+		tick = (next_tick + step - 1) & ~(step - 1);
+		for (i = 0; i < SWTIMER_SLOTS; i++, tick += step)
+		{
+			swtimer_node_t* slot = &wheel[level][(tick >> shift) & SWTIMER_SLOT_MASK];
+
+			if (slot->next != slot)
+			{
+				if ((tick - now) < best)
+				{
+					best = tick - now;
+				}
+				break;
+			}
+		}
+	}
+
+	return best;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Make an empty list
+  * @param	List head
+  * @retval	None
+  ******************************************************************************
+  */
+static void swtimer_list_init(swtimer_node_t* head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Append node at the list tail
+  * @param	List head
+  * @param	Node
+  * @retval	None
+  ******************************************************************************
+  */
+static void swtimer_list_add(swtimer_node_t* head, swtimer_node_t* node)
+{
+	node->next = head;
+	node->prev = head->prev;
+	head->prev->next = node;
+	head->prev = node;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Unlink node from its list and mark it inactive
+  * @param	Node
+  * @retval	None
+  ******************************************************************************
+  */
+static void swtimer_list_del(swtimer_node_t* node)
+{
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->next = 0;
+	node->prev = 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Move all nodes of a list to an empty list
+  * @param	Source list head
+  * @param	Empty destination list head
+  * @retval	None
+  ******************************************************************************
+  */
+static void swtimer_list_move(swtimer_node_t* from, swtimer_node_t* to)
+{
+	if (from->next != from)
+	{
+		to->next = from->next;
+		to->prev = from->prev;
+		to->next->prev = to;
+		to->prev->next = to;
+		swtimer_list_init(from);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Put timer in a slot according to its distance from now
+  * @param	Pointer to timer object
+  * @retval	None
+  ******************************************************************************
+  */
+static void swtimer_insert(swtimer_t* timer)
+{
+	uint32_t expires = timer->expires;
+	int32_t delta = (int32_t)(expires - next_tick);
+	uint8_t level = 0;
+
+	if (delta < 0)
+	{
+		// Already due, run on the next processed tick
+		delta = 0;
+		expires = next_tick;
+	}
+	else if ((uint32_t)delta >= (1UL << (SWTIMER_SLOT_BITS * SWTIMER_LEVELS)))
+	{
+		// Too far away, park it at the end of the wheel
+		delta = (1UL << (SWTIMER_SLOT_BITS * SWTIMER_LEVELS)) - 1;
+		expires = next_tick + delta;
+	}
+
+	// Find the lowest level whose range covers the delta
+	while ((level < SWTIMER_LEVELS - 1) &&
+		((uint32_t)delta >= (1UL << (SWTIMER_SLOT_BITS * (level + 1)))))
+	{
+		level++;
+	}
+
+	swtimer_list_add(&wheel[level][(expires >> (SWTIMER_SLOT_BITS * level)) &
+		SWTIMER_SLOT_MASK], &timer->node);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Re-insert the timers of the current slot of a level
+  * @param	Wheel level (1 to SWTIMER_LEVELS - 1)
+  * @retval	Slot index that was cascaded (0 means the level wrapped too)
+  ******************************************************************************
+  */
+static uint8_t swtimer_cascade(uint8_t level)
+{
+	uint8_t index = (next_tick >> (SWTIMER_SLOT_BITS * level)) & SWTIMER_SLOT_MASK;
+	swtimer_node_t list;
+
+	swtimer_list_init(&list);
+	swtimer_list_move(&wheel[level][index], &list);
+	while (list.next != &list)
+	{
+		swtimer_t* timer = (swtimer_t*)list.next;
+
+		swtimer_list_del(&timer->node);
+		swtimer_insert(timer);
+	}
+
+	return index;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,624 @@
+/**
+  ******************************************************************************
+  * @file		dma_mem.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "dma_mem.h"
+
+/** Private defines --------------------------------------------------------- */
+// Max items per DMA transfer (16-bit CNDTR)
+#define DMA_MEM_MAX_ITEMS	0xFFFF
+
+// Channel states
+#define DMA_MEM_FREE			0
+#define DMA_MEM_BUSY			1
+#define DMA_MEM_DONE			2
+#define DMA_MEM_ERROR			3
+
+/** Private typedefs -------------------------------------------------------- */
+typedef struct
+{
+	__IO uint8_t state;
+	uint8_t size;									// Item size in bytes (1, 2 or 4)
+	uint8_t fill;									// Source is the fixed pattern word
+	uint32_t src;
+	uint32_t dst;
+	uint32_t remaining;						// Items not yet started
+	uint16_t chunk;								// Items of the running transfer
+	uint32_t pattern;							// Fill value for memset
+	const dma_desc_t* desc;				// Running chain segment, 0 = block job
+	dma_mem_callback_t callback;
+	void* arg;
+} dma_mem_job_t;
+
+/** Private variables ------------------------------------------------------- */
+static DMA_Channel_TypeDef* const channels[DMA_MEM_CHANNELS] =
+{
+	DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4,
+	DMA1_Channel5, DMA1_Channel6, DMA1_Channel7
+};
+static const IRQn_Type channelIRQs[DMA_MEM_CHANNELS] =
+{
+	DMA1_Channel1_IRQn, DMA1_Channel2_IRQn, DMA1_Channel3_IRQn,
+	DMA1_Channel4_IRQn, DMA1_Channel5_IRQn, DMA1_Channel6_IRQn,
+	DMA1_Channel7_IRQn
+};
+static dma_mem_job_t jobs[DMA_MEM_CHANNELS];
+static dma_chain_stats_t chainStats;
+
+/** Private function prototypes --------------------------------------------- */
+static int8_t dma_mem_alloc(void);
+static uint8_t dma_mem_item_size(uint32_t address, uint32_t len);
+static void dma_mem_start(uint8_t ch);
+static const dma_desc_t* dma_desc_skip(const dma_desc_t* desc);
+static void dma_desc_start(uint8_t ch, const dma_desc_t* desc);
+static void dma_mem_irq(uint8_t ch);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize DMA1 clock and the channel interrupts of the pool
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void dma_mem_init()
+{
+	NVIC_InitTypeDef NVIC_InitStruct;
+	uint8_t ch;
+
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	for (ch = 0; ch < DMA_MEM_CHANNELS; ch++)
+	{
+		if (DMA_MEM_POOL & (1 << ch))
+		{
+			channels[ch]->CCR = 0;
+			DMA1->IFCR = DMA_IFCR_CGIF1 << (ch * 4);
+			jobs[ch].state = DMA_MEM_FREE;
+
+			// Set DMA IRQ at lower priority than SysTick
+			NVIC_InitStruct.NVIC_IRQChannel = channelIRQs[ch];
+			NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+			NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+			NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+			NVIC_Init(&NVIC_InitStruct);
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start copying a memory block with DMA
+  * @param	Destination address
+  * @param	Source address
+  * @param	Number of bytes
+  * @param	Function called from dma_mem_process() when done, may be 0
+  * @param	Argument passed to the callback
+  * @retval	1 if started, 0 if no channel is free
+  ******************************************************************************
+  */
+uint8_t dma_memcpy_async(void* dst, const void* src, uint32_t len, 
+	dma_mem_callback_t callback, void* arg)
+{
+	uint8_t* d = (uint8_t*)dst;
+	const uint8_t* s = (const uint8_t*)src;
+	uint32_t head, tail;
+	uint8_t size;
+	int8_t ch = dma_mem_alloc();
+
+	if (ch < 0)
+	{
+		return 0;
+	}
+
+	// Both addresses must have the same offset within an item. The bytes
+	// before the first and after the last full item are copied by the CPU.
+	size = dma_mem_item_size((uint32_t)d ^ (uint32_t)s, len);
+	head = (size - ((uint32_t)d & (size - 1))) & (size - 1);
+	if (head > len)
+	{
+		head = len;
+	}
+	tail = (len - head) & (size - 1);
+	len -= head + tail;
+	while (tail--)
+	{
+		d[head + len + tail] = s[head + len + tail];
+	}
+	while (head--)
+	{
+		*d++ = *s++;
+	}
+
+	jobs[ch].size = size;
+	jobs[ch].fill = 0;
+	jobs[ch].desc = 0;
+	jobs[ch].src = (uint32_t)s;
+	jobs[ch].dst = (uint32_t)d;
+	jobs[ch].remaining = len / size;
+	jobs[ch].callback = callback;
+	jobs[ch].arg = arg;
+	dma_mem_start(ch);
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start filling a memory block with DMA
+  * @param	Destination address
+  * @param	Fill value
+  * @param	Number of bytes
+  * @param	Function called from dma_mem_process() when done, may be 0
+  * @param	Argument passed to the callback
+  * @retval	1 if started, 0 if no channel is free
+  ******************************************************************************
+  */
+uint8_t dma_memset_async(void* dst, uint8_t value, uint32_t len, 
+	dma_mem_callback_t callback, void* arg)
+{
+	uint8_t* d = (uint8_t*)dst;
+	uint32_t head, tail;
+	int8_t ch = dma_mem_alloc();
+
+	if (ch < 0)
+	{
+		return 0;
+	}
+
+	// Word writes from the aligned address on, CPU fills the ends
+	head = (4 - ((uint32_t)d & 3)) & 3;
+	if (head > len)
+	{
+		head = len;
+	}
+	tail = (len - head) & 3;
+	len -= head + tail;
+	while (tail--)
+	{
+		d[head + len + tail] = value;
+	}
+	while (head--)
+	{
+		*d++ = value;
+	}
+
+	jobs[ch].size = 4;
+	jobs[ch].fill = 1;
+	jobs[ch].desc = 0;
+	jobs[ch].pattern = value * 0x01010101UL;
+	jobs[ch].src = (uint32_t)&jobs[ch].pattern;
+	jobs[ch].dst = (uint32_t)d;
+	jobs[ch].remaining = len / 4;
+	jobs[ch].callback = callback;
+	jobs[ch].arg = arg;
+	dma_mem_start(ch);
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start a descriptor chain. For peripheral segments the caller
+  *					must enable the DMA request of the peripheral.
+  * @param	DMA1 channel number 1 to 7 (must be in the pool), or DMA_MEM_ANY
+  * @param	First descriptor, the chain must stay valid until done
+  * @param	Function called from dma_mem_process() when done, may be 0
+  * @param	Argument passed to the callback
+  * @retval	1 if started, 0 if the channel is not free
+  ******************************************************************************
+  */
+uint8_t dma_chain_start(uint8_t channel, const dma_desc_t* chain, 
+	dma_mem_callback_t callback, void* arg)
+{
+	int8_t ch;
+
+	if (channel == DMA_MEM_ANY)
+	{
+		ch = dma_mem_alloc();
+		if (ch < 0)
+		{
+			return 0;
+		}
+	}
+	else
+	{
+		ch = channel - 1;
+		if ((channel > DMA_MEM_CHANNELS) || !(DMA_MEM_POOL & (1 << ch)) ||
+			(jobs[ch].state != DMA_MEM_FREE))
+		{
+			return 0;
+		}
+		jobs[ch].state = DMA_MEM_BUSY;
+	}
+
+	jobs[ch].callback = callback;
+	jobs[ch].arg = arg;
+	jobs[ch].desc = dma_desc_skip(chain);
+	chainStats.chains++;
+	if (jobs[ch].desc)
+	{
+		dma_desc_start(ch, jobs[ch].desc);
+	}
+	else
+	{
+		jobs[ch].state = DMA_MEM_DONE;
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get descriptor chain statistics
+  * @param	Pointer to destination
+  * @retval	None
+  ******************************************************************************
+  */
+void dma_chain_get_stats(dma_chain_stats_t* stats)
+{
+	__disable_irq();
+	*stats = chainStats;
+	__enable_irq();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Clear descriptor chain statistics
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void dma_chain_reset_stats()
+{
+	__disable_irq();
+	chainStats.chains = 0;
+	chainStats.segments = 0;
+	chainStats.gap_max = 0;
+	chainStats.gap_sum = 0;
+	__enable_irq();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Release finished channels and run their callbacks.
+  *					Call this from the main loop.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void dma_mem_process()
+{
+	uint8_t ch;
+
+	for (ch = 0; ch < DMA_MEM_CHANNELS; ch++)
+	{
+		uint8_t state = jobs[ch].state;
+
+		if ((state == DMA_MEM_DONE) || (state == DMA_MEM_ERROR))
+		{
+			dma_mem_callback_t callback = jobs[ch].callback;
+			void* arg = jobs[ch].arg;
+
+			// Free the channel first, the callback may start a new transfer
+			jobs[ch].state = DMA_MEM_FREE;
+			if (callback)
+			{
+				callback(arg, state == DMA_MEM_ERROR);
+			}
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether any transfer is still running
+  * @param	None
+  * @retval	1 if busy, otherwise 0
+  ******************************************************************************
+  */
+uint8_t dma_mem_busy()
+{
+	uint8_t ch;
+
+	for (ch = 0; ch < DMA_MEM_CHANNELS; ch++)
+	{
+		if (jobs[ch].state == DMA_MEM_BUSY)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether a finished transfer waits for dma_mem_process()
+  * @param	None
+  * @retval	1 if a callback is pending, otherwise 0
+  ******************************************************************************
+  */
+uint8_t dma_mem_pending()
+{
+	uint8_t ch;
+
+	for (ch = 0; ch < DMA_MEM_CHANNELS; ch++)
+	{
+		if ((jobs[ch].state == DMA_MEM_DONE) || (jobs[ch].state == DMA_MEM_ERROR))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#if (DMA_MEM_POOL & 0x01)
+void DMA1_Channel1_IRQHandler()
+{
+	dma_mem_irq(0);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x02)
+void DMA1_Channel2_IRQHandler()
+{
+	dma_mem_irq(1);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x04)
+void DMA1_Channel3_IRQHandler()
+{
+	dma_mem_irq(2);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x08)
+void DMA1_Channel4_IRQHandler()
+{
+	dma_mem_irq(3);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x10)
+void DMA1_Channel5_IRQHandler()
+{
+	dma_mem_irq(4);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x20)
+void DMA1_Channel6_IRQHandler()
+{
+	dma_mem_irq(5);
+}
+#endif
+
+#if (DMA_MEM_POOL & 0x40)
+void DMA1_Channel7_IRQHandler()
+{
+	dma_mem_irq(6);
+}
+#endif
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Take a free channel of the pool
+  * @param	None
+  * @retval	Channel index (0 = DMA1 channel 1), -1 if none is free
+  ******************************************************************************
+  */
+static int8_t dma_mem_alloc()
+{
+	int8_t ch;
+
+	// Start from the highest channel, peripheral drivers tend to use
+	// the low ones and fixed priority favours low channel numbers
+	for (ch = DMA_MEM_CHANNELS - 1; ch >= 0; ch--)
+	{
+		if ((DMA_MEM_POOL & (1 << ch)) && (jobs[ch].state == DMA_MEM_FREE))
+		{
+			jobs[ch].state = DMA_MEM_BUSY;
+			return ch;
+		}
+	}
+
+	return -1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the widest item size an address offset and length allow
+  * @param	Address bits that must be aligned
+  * @param	Number of bytes
+  * @retval	Item size in bytes
+  ******************************************************************************
+  */
+static uint8_t dma_mem_item_size(uint32_t address, uint32_t len)
+{
+	if (((address & 3) == 0) && (len >= 4))
+	{
+		return 4;
+	}
+	if (((address & 1) == 0) && (len >= 2))
+	{
+		return 2;
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Program and enable the next chunk of a channel, or mark the job
+  *					done when nothing is left
+  * @param	Channel index
+  * @retval	None
+  ******************************************************************************
+  */
+static void dma_mem_start(uint8_t ch)
+{
+	dma_mem_job_t* job = &jobs[ch];
+	DMA_Channel_TypeDef* channel = channels[ch];
+	uint32_t ccr;
+
+	if (job->remaining == 0)
+	{
+		job->state = DMA_MEM_DONE;
+		return;
+	}
+
+	job->chunk = (job->remaining > DMA_MEM_MAX_ITEMS) ? 
+		DMA_MEM_MAX_ITEMS : job->remaining;
+	job->remaining -= job->chunk;
+
+	// Peripheral side is the source, memory side the destination.
+	// Low priority, peripheral channels must not wait for bulk copies.
+	ccr = DMA_CCR1_MEM2MEM | DMA_CCR1_MINC | DMA_CCR1_TCIE | DMA_CCR1_TEIE;
+	if (!job->fill)
+	{
+		ccr |= DMA_CCR1_PINC;
+	}
+	if (job->size == 4)
+	{
+		ccr |= DMA_CCR1_PSIZE_1 | DMA_CCR1_MSIZE_1;
+	}
+	else if (job->size == 2)
+	{
+		ccr |= DMA_CCR1_PSIZE_0 | DMA_CCR1_MSIZE_0;
+	}
+
+	channel->CCR = 0;
+	channel->CPAR = job->src;
+	channel->CMAR = job->dst;
+	channel->CNDTR = job->chunk;
+	channel->CCR = ccr;
+	channel->CCR = ccr | DMA_CCR1_EN;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Skip empty segments, a zero count would never complete
+  * @param	Descriptor
+  * @retval	First non-empty descriptor, 0 if none is left
+  ******************************************************************************
+  */
+static const dma_desc_t* dma_desc_skip(const dma_desc_t* desc)
+{
+	while (desc && (desc->len == 0))
+	{
+		desc = desc->next;
+	}
+
+	return desc;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Program and enable a chain segment
+  * @param	Channel index
+  * @param	Descriptor
+  * @retval	None
+  ******************************************************************************
+  */
+static void dma_desc_start(uint8_t ch, const dma_desc_t* desc)
+{
+	DMA_Channel_TypeDef* channel = channels[ch];
+	uint32_t ccr = DMA_CCR1_DIR | DMA_CCR1_TCIE | DMA_CCR1_TEIE | DMA_CCR1_EN;
+
+	if (desc->flags & DMA_DESC_SRC_INC)
+	{
+		ccr |= DMA_CCR1_MINC;
+	}
+	if (desc->flags & DMA_DESC_DST_INC)
+	{
+		ccr |= DMA_CCR1_PINC;
+	}
+	if (desc->flags & DMA_DESC_M2M)
+	{
+		ccr |= DMA_CCR1_MEM2MEM;
+	}
+	if (desc->width == 4)
+	{
+		ccr |= DMA_CCR1_PSIZE_1 | DMA_CCR1_MSIZE_1;
+	}
+	else if (desc->width == 2)
+	{
+		ccr |= DMA_CCR1_PSIZE_0 | DMA_CCR1_MSIZE_0;
+	}
+
+	// Addresses and count can only be written while disabled,
+	// configuration and enable go in one write
+	channel->CCR = 0;
+	channel->CMAR = (uint32_t)desc->src;
+	channel->CPAR = (uint32_t)desc->dst;
+	channel->CNDTR = desc->len;
+	channel->CCR = ccr;
+	chainStats.segments++;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Channel interrupt: chain the next chunk or finish the job
+  * @param	Channel index
+  * @retval	None
+  ******************************************************************************
+  */
+static void dma_mem_irq(uint8_t ch)
+{
+	uint32_t entry = DWT->CYCCNT;
+	dma_mem_job_t* job = &jobs[ch];
+	uint32_t flags = DMA1->ISR >> (ch * 4);
+	uint32_t bytes;
+
+	DMA1->IFCR = DMA_IFCR_CGIF1 << (ch * 4);
+
+	if (flags & DMA_ISR_TEIF1)
+	{
+		// Channel is disabled by hardware on a bus error
+		channels[ch]->CCR = 0;
+		job->state = DMA_MEM_ERROR;
+		return;
+	}
+
+	if ((flags & DMA_ISR_TCIF1) && job->desc)
+	{
+		job->desc = dma_desc_skip(job->desc->next);
+		if (job->desc)
+		{
+			dma_desc_start(ch, job->desc);
+			entry = DWT->CYCCNT - entry;
+			chainStats.gap_sum += entry;
+			if (entry > chainStats.gap_max)
+			{
+				chainStats.gap_max = entry;
+			}
+		}
+		else
+		{
+			channels[ch]->CCR = 0;
+			job->state = DMA_MEM_DONE;
+		}
+	}
+	else if (flags & DMA_ISR_TCIF1)
+	{
+		bytes = (uint32_t)job->chunk * job->size;
+		job->dst += bytes;
+		if (!job->fill)
+		{
+			job->src += bytes;
+		}
+		dma_mem_start(ch);
+	}
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file		dma_mem.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Asynchronous memory copy and fill with DMA1 memory-to-memory
+	*					transfers. Each transfer takes a free channel from the pool,
+	*					uses the widest item size the alignment allows (unaligned head
+	*					and tail bytes are done by the CPU) and is split into chunks of
+	*					65535 items. Callbacks run from dma_mem_process() in the main
+	*					loop, not from the interrupt. Start transfers from the main loop
+	*					only. Overlapping buffers are not supported.
+	*					Descriptor chains emulate scatter-gather: the TC interrupt walks
+	*					a linked list of segments and re-arms the channel for each one.
+  ******************************************************************************
+  */
+
+#ifndef __DMA_MEM_H
+#define __DMA_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+// DMA1 channels owned by the pool (bit 0 = channel 1). Leave out channels
+// used by peripheral drivers, their IRQ handlers are not defined here.
+#define DMA_MEM_POOL			0x7F
+#define DMA_MEM_CHANNELS	7
+// Pass to dma_chain_start() to use any free channel (memory-to-memory only)
+#define DMA_MEM_ANY				0
+
+// Descriptor flags
+#define DMA_DESC_SRC_INC	0x01	// Increment source address
+#define DMA_DESC_DST_INC	0x02	// Increment destination address
+#define DMA_DESC_M2M			0x04	// Run without peripheral request
+
+/** Typedefs ---------------------------------------------------------------- */
+// Called from dma_mem_process(), error is 1 if DMA reported a bus error
+typedef void (*dma_mem_callback_t)(void* arg, uint8_t error);
+
+// Chain segment. Source goes to CMAR and destination to CPAR (DIR = 1), 
+// so either side may be a peripheral data register.
+typedef struct dma_desc
+{
+	const volatile void* src;
+	volatile void* dst;
+	uint16_t len;									// Number of items, 0 = skip segment
+	uint8_t width;								// Item size in bytes (1, 2 or 4)
+	uint8_t flags;
+	const struct dma_desc* next;	// Next segment, 0 = end of chain
+} dma_desc_t;
+
+// Re-arm gap: cycles from TC interrupt entry until the next segment is
+// enabled, read from the DWT cycle counter (enabled by DelayInit())
+typedef struct
+{
+	uint32_t chains;
+	uint32_t segments;
+	uint32_t gap_max;
+	uint32_t gap_sum;							// Sum over (segments - chains) re-arms
+} dma_chain_stats_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void dma_mem_init(void);
+uint8_t dma_memcpy_async(void* dst, const void* src, uint32_t len, 
+	dma_mem_callback_t callback, void* arg);
+uint8_t dma_memset_async(void* dst, uint8_t value, uint32_t len, 
+	dma_mem_callback_t callback, void* arg);
+uint8_t dma_chain_start(uint8_t channel, const dma_desc_t* chain, 
+	dma_mem_callback_t callback, void* arg);
+void dma_chain_get_stats(dma_chain_stats_t* stats);
+void dma_chain_reset_stats(void);
+void dma_mem_process(void);
+uint8_t dma_mem_busy(void);
+uint8_t dma_mem_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
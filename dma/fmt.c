@@ -0,0 +1,343 @@
+/**
+  ******************************************************************************
+  * @file		fmt.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "fmt.h"
+
+/** Private variables ------------------------------------------------------- */
+static const char hex_digits[16] = {
+	'0', '1', '2', '3', '4', '5', '6', '7',
+	'8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// Powers of 10 for fixed-point fraction scaling
+static const uint32_t pow10[10] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/** Private function prototypes --------------------------------------------- */
+static uint8_t fmt_utoa_rev(char* end, uint32_t val);
+static uint8_t fmt_put_field(char* dst, const char* digits, uint8_t len,
+	uint8_t negative, uint8_t width, char pad);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Blank a fixed-width line buffer and terminate it
+  * @param	Pointer to line buffer (must hold len + 1 chars)
+  * @param	Visible line length
+  * @retval	None
+  ******************************************************************************
+  */
+void fmt_line_init(char* line, uint8_t len)
+{
+	fmt_fill(line, ' ', len);
+	line[len] = '\0';
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Fill a field with the same char
+  * @param	Pointer to destination
+  * @param	Fill char
+  * @param	Number of chars
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_fill(char* dst, char c, uint8_t len)
+{
+	uint8_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		dst[i] = c;
+	}
+
+	return len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Copy a string into a field, padded with spaces or truncated
+  * @param	Pointer to destination
+  * @param	Null terminated source string
+  * @param	Field width (0 = string length)
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_str(char* dst, const char* s, uint8_t width)
+{
+	uint8_t i = 0;
+
+	while (*s && (width == 0 || i < width))
+	{
+		dst[i++] = *s++;
+	}
+	while (i < width)
+	{
+		dst[i++] = ' ';
+	}
+
+	return i;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format unsigned decimal value, right aligned
+  * @param	Pointer to destination
+  * @param	Value
+  * @param	Field width (0 = as many digits as needed)
+  * @param	Pad char (FMT_PAD_ZERO or FMT_PAD_SPACE)
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_dec(char* dst, uint32_t val, uint8_t width, char pad)
+{
+	char tmp[FMT_DEC_MAX];
+	uint8_t len = fmt_utoa_rev(&tmp[FMT_DEC_MAX], val);
+
+	return fmt_put_field(dst, &tmp[FMT_DEC_MAX - len], len, 0, width, pad);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format signed decimal value, right aligned
+  * @param	Pointer to destination
+  * @param	Value
+  * @param	Field width including sign (0 = as many chars as needed)
+  * @param	Pad char (FMT_PAD_ZERO or FMT_PAD_SPACE)
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_int(char* dst, int32_t val, uint8_t width, char pad)
+{
+	char tmp[FMT_DEC_MAX];
+	// Negate in unsigned domain so INT32_MIN is handled
+	uint32_t mag = (val < 0) ? (0u - (uint32_t)val) : (uint32_t)val;
+	uint8_t len = fmt_utoa_rev(&tmp[FMT_DEC_MAX], mag);
+
+	return fmt_put_field(dst, &tmp[FMT_DEC_MAX - len], len, val < 0, width, pad);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format value as fixed number of uppercase hex digits
+  * @param	Pointer to destination
+  * @param	Value
+  * @param	Number of hex digits (1-8)
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_hex(char* dst, uint32_t val, uint8_t digits)
+{
+	uint8_t i = digits;
+
+	while (i)
+	{
+		dst[--i] = hex_digits[val & 0x0F];
+		val >>= 4;
+	}
+
+	return digits;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format signed fixed-point value (Qn) with rounding, right aligned
+  * @param	Pointer to destination
+  * @param	Fixed-point value
+  * @param	Number of fractional bits (0-31)
+  * @param	Number of decimal places to print (0-9)
+  * @param	Field width including sign and point (0 = as many as needed)
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+uint8_t fmt_fixed(char* dst, int32_t val, uint8_t frac_bits, uint8_t decimals,
+	uint8_t width)
+{
+	char tmp[FMT_DEC_MAX + 10];
+	char* end = &tmp[sizeof(tmp)];
+	uint32_t mag = (val < 0) ? (0u - (uint32_t)val) : (uint32_t)val;
+	uint32_t ipart = mag >> frac_bits;
+	uint32_t fpart = 0;
+	uint8_t negative;
+	uint8_t len = 0;
+
+	if (frac_bits)
+	{
+		// Scale fraction to decimal places and round half up
+		// (single UMULL on Cortex-M3)
+		uint64_t f = (uint64_t)(mag & ((1u << frac_bits) - 1)) * pow10[decimals];
+		fpart = (uint32_t)((f + (1u << (frac_bits - 1))) >> frac_bits);
+		if (fpart >= pow10[decimals])
+		{
+			fpart -= pow10[decimals];
+			ipart++;
+		}
+	}
+
+	// Do not print "-0.00"
+	negative = (val < 0) && (ipart || fpart);
+
+	if (decimals)
+	{
+		uint8_t i;
+
+		for (i = 0; i < decimals; i++)
+		{
+			*--end = '0' + (fpart % 10);
+			fpart /= 10;
+		}
+		*--end = '.';
+		len = decimals + 1;
+	}
+	len += fmt_utoa_rev(end, ipart);
+
+	return fmt_put_field(dst, &tmp[sizeof(tmp) - len], len, negative, width,
+		FMT_PAD_SPACE);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format value 0-99 as exactly two digits
+  * @param	Pointer to destination
+  * @param	Value (0-99)
+  * @retval	Number of chars written (always 2)
+  ******************************************************************************
+  */
+uint8_t fmt_2digit(char* dst, uint8_t val)
+{
+	uint8_t tens = val / 10;
+
+	dst[0] = '0' + tens;
+	dst[1] = '0' + (val - (tens * 10));
+
+	return 2;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format time as "HH:MM:SS"
+  * @param	Pointer to destination
+  * @param	Hours
+  * @param	Minutes
+  * @param	Seconds
+  * @retval	Number of chars written (always 8)
+  ******************************************************************************
+  */
+uint8_t fmt_time(char* dst, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+	fmt_2digit(&dst[0], hours);
+	dst[2] = ':';
+	fmt_2digit(&dst[3], minutes);
+	dst[5] = ':';
+	fmt_2digit(&dst[6], seconds);
+
+	return 8;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Format date as "DD/MM/20YY"
+  * @param	Pointer to destination
+  * @param	Date
+  * @param	Month
+  * @param	Year (0-99)
+  * @retval	Number of chars written (always 10)
+  ******************************************************************************
+  */
+uint8_t fmt_date(char* dst, uint8_t date, uint8_t month, uint8_t year)
+{
+	fmt_2digit(&dst[0], date);
+	dst[2] = '/';
+	fmt_2digit(&dst[3], month);
+	dst[5] = '/';
+	dst[6] = '2';
+	dst[7] = '0';
+	fmt_2digit(&dst[8], year);
+
+	return 10;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Convert unsigned value to decimal digits, written backwards
+  * @param	Pointer one past the last digit
+  * @param	Value
+  * @retval	Number of digits written
+  ******************************************************************************
+  */
+static uint8_t fmt_utoa_rev(char* end, uint32_t val)
+{
+	uint8_t len = 0;
+
+	// Division by constant 10 is compiled to a multiply, no UDIV needed
+	do
+	{
+		uint32_t q = val / 10;
+		*--end = '0' + (val - (q * 10));
+		val = q;
+		len++;
+	} while (val);
+
+	return len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Copy digits into a right aligned field with sign and padding
+  * @param	Pointer to destination
+  * @param	Pointer to digits
+  * @param	Number of digits
+  * @param	Non-zero if value is negative
+  * @param	Field width (0 = no padding)
+  * @param	Pad char
+  * @retval	Number of chars written
+  ******************************************************************************
+  */
+static uint8_t fmt_put_field(char* dst, const char* digits, uint8_t len,
+	uint8_t negative, uint8_t width, char pad)
+{
+	uint8_t total = len + (negative ? 1 : 0);
+	uint8_t i = 0;
+
+	if (width == 0)
+	{
+		width = total;
+	}
+	else if (total > width)
+	{
+		// Value does not fit, keep the layout and mark the field
+		return fmt_fill(dst, FMT_OVERFLOW, width);
+	}
+
+	// Sign goes before zero padding but after space padding
+	if (negative && pad == FMT_PAD_ZERO)
+	{
+		dst[i++] = '-';
+		negative = 0;
+	}
+	while (i < width - len - (negative ? 1 : 0))
+	{
+		dst[i++] = pad;
+	}
+	if (negative)
+	{
+		dst[i++] = '-';
+	}
+	while (len--)
+	{
+		dst[i++] = *digits++;
+	}
+
+	return width;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -1,34 +1,54 @@
 #include "stm32f10x.h"
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
-#include "stm32f10x_dma.h"
+#include <string.h>
 #include "delay.h"
 #include "lcd16x2.h"
+#include "dma_mem.h"
+#include "fmt.h"
 
-#define BUF_SIZE	29
+#define BUF_SIZE	30
+// Benchmark block sizes, from an audio buffer up to a framebuffer slice
+#define BENCH_SIZES	5
+#define BENCH_MAX		4096
 
-void DMA1_Init(void);
+uint32_t Copy_Benchmark(uint32_t len, uint8_t dma);
+void Copy_Done(void* arg, uint8_t error);
+void LCD_PrintCycles(const char* label, uint32_t cycles);
 
 GPIO_InitTypeDef GPIO_InitStruct;
 char source[BUF_SIZE] = "Message from\nMemory using DMA";
 char destination[BUF_SIZE];
-		
-void DMA1_Channel1_IRQHandler()
+__IO uint8_t copyDone;
+// Gather the message from three separate strings without a bounce buffer
+const char header[] = "Message from\n";
+const char middle[] = "Memory ";
+const char trailer[] = "using DMA";
+const dma_desc_t gather[3] =
 {
-	if(DMA_GetITStatus(DMA1_IT_TC1))
-	{
-		// Display received data to the LCD
-		lcd16x2_clrscr();
-		lcd16x2_puts(destination);
+	{header, destination, sizeof(header) - 1, 1,
+		DMA_DESC_SRC_INC | DMA_DESC_DST_INC | DMA_DESC_M2M, &gather[1]},
+	{middle, destination + sizeof(header) - 1, sizeof(middle) - 1, 1,
+		DMA_DESC_SRC_INC | DMA_DESC_DST_INC | DMA_DESC_M2M, &gather[2]},
+	{trailer, destination + sizeof(header) + sizeof(middle) - 2, 
+		sizeof(trailer) - 1, 1, DMA_DESC_SRC_INC | DMA_DESC_DST_INC | DMA_DESC_M2M, 0}
+};
+dma_chain_stats_t chainStats;
 
-		// Clear DMA1 Channel1 half transfer, transfer complete and 
-		// global interrupt pending bits
-		DMA_ClearITPendingBit(DMA1_IT_GL1);
-	}
-}
+const uint16_t benchSizes[BENCH_SIZES] = {64, 256, 512, 1024, BENCH_MAX};
+uint32_t benchSrc[BENCH_MAX / 4];
+uint32_t benchDst[BENCH_MAX / 4];
+// Cycles per block size, CPU memcpy and DMA (start until done)
+uint32_t cpuCycles[BENCH_SIZES];
+uint32_t dmaCycles[BENCH_SIZES];
+// Smallest benchmarked size where DMA is faster, 0 if never
+uint32_t breakEven;
 
 int main(void)
 {
+	uint8_t i;
+	uint8_t copies = 0;
+	
 	DelayInit();
 	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
 	
@@ -38,52 +58,113 @@ int main(void)
 	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_Init(GPIOA, &GPIO_InitStruct);
 	// Initialize DMA
-	DMA1_Init();
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
+	dma_mem_init();
+	
+	// Compare CPU memcpy and DMA for word aligned blocks
+	breakEven = 0;
+	for (i = 0; i < BENCH_SIZES; i++)
+	{
+		cpuCycles[i] = Copy_Benchmark(benchSizes[i], 0);
+		dmaCycles[i] = Copy_Benchmark(benchSizes[i], 1);
+		if ((breakEven == 0) && (dmaCycles[i] < cpuCycles[i]))
+		{
+			breakEven = benchSizes[i];
+		}
+	}
+	lcd16x2_clrscr();
+	LCD_PrintCycles("CPU 4K", cpuCycles[BENCH_SIZES - 1]);
+	lcd16x2_gotoxy(0, 1);
+	LCD_PrintCycles("DMA 4K", dmaCycles[BENCH_SIZES - 1]);
+	DelayMs(2000);
+	lcd16x2_clrscr();
+	if (breakEven)
+	{
+		LCD_PrintCycles("DMA wins", breakEven);
+		lcd16x2_puts("B");
+	}
+	else
+	{
+		lcd16x2_puts("CPU memcpy wins");
+	}
+	DelayMs(2000);
 	
 	// Wait until button is pressed
 	lcd16x2_clrscr();
 	lcd16x2_puts("Press Button to\nStart Transfer");
 	while (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_0));
-	// Start transfer data using DMA
-	DMA_Cmd(DMA1_Channel1, ENABLE);
+	// Start transfer data using DMA, first as one block then gathered
+	copyDone = 0;
+	dma_memcpy_async(destination, source, BUF_SIZE, Copy_Done, 0);
 
 	while (1)
 	{
+		// Run callbacks of finished transfers
+		dma_mem_process();
+		if (copyDone)
+		{
+			copyDone = 0;
+			// Display received data to the LCD
+			lcd16x2_clrscr();
+			lcd16x2_puts(destination);
+			if (++copies == 1)
+			{
+				DelayMs(2000);
+				memset(destination, 0, BUF_SIZE);
+				dma_chain_start(DMA_MEM_ANY, gather, Copy_Done, 0);
+			}
+			else
+			{
+				// Re-arm gap between the chain segments
+				DelayMs(2000);
+				dma_chain_get_stats(&chainStats);
+				lcd16x2_clrscr();
+				LCD_PrintCycles("Gap avg", chainStats.gap_sum / 
+					(chainStats.segments - chainStats.chains));
+				lcd16x2_gotoxy(0, 1);
+				LCD_PrintCycles("Gap max", chainStats.gap_max);
+			}
+		}
+		// Nothing to do until a transfer finishes
+		DelayIdleUntil(dma_mem_pending, DELAY_IDLE_FOREVER);
 	}
 }
 
-void DMA1_Init()
+uint32_t Copy_Benchmark(uint32_t len, uint8_t dma)
 {
-	// Initialization struct
-	DMA_InitTypeDef DMA_InitStruct;
-	NVIC_InitTypeDef NVIC_InitStruct;
+	uint32_t start;
 	
-	// Step 1: Initialize DMA
-	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
-	DMA_DeInit(DMA1_Channel1);
-	DMA_InitStruct.DMA_M2M = DMA_M2M_Enable;
-	DMA_InitStruct.DMA_Mode = DMA_Mode_Normal;
-	DMA_InitStruct.DMA_Priority = DMA_Priority_Medium;
-	DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
-	DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
-	DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
-	DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Enable;
-	DMA_InitStruct.DMA_DIR = DMA_DIR_PeripheralSRC;
-	DMA_InitStruct.DMA_BufferSize = BUF_SIZE;
-	DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t) source;
-	DMA_InitStruct.DMA_MemoryBaseAddr = (uint32_t) destination;
-	DMA_Init(DMA1_Channel1, &DMA_InitStruct);
-	// Enable DMA1 transfer complete interrupt
-	DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+	copyDone = 0;
+	start = DelayGetCycles();
+	if (dma)
+	{
+		dma_memcpy_async(benchDst, benchSrc, len, Copy_Done, 0);
+		while (!copyDone)
+		{
+			dma_mem_process();
+		}
+	}
+	else
+	{
+		memcpy(benchDst, benchSrc, len);
+	}
 	
-	// Step 2: Initialize NVIC
-	// Set NVIC prority group to group 4 
-	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
-	// Set System Timer IRQ at higher priority
-	NVIC_SetPriority(SysTick_IRQn, 0);
-	// Set DMA1 channel 1 IRQ at lower priority
-	NVIC_InitStruct.NVIC_IRQChannel = DMA1_Channel1_IRQn;
-	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
-	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
-	NVIC_Init(&NVIC_InitStruct);
+	return DelayGetCycles() - start;
+}
+
+void Copy_Done(void* arg, uint8_t error)
+{
+	copyDone = 1;
+}
+
+void LCD_PrintCycles(const char* label, uint32_t cycles)
+{
+	char line[16];
+	uint8_t n;
+	
+	n = fmt_str(line, label, 9);
+	n += fmt_dec(&line[n], cycles, 6, FMT_PAD_SPACE);
+	line[n] = '\0';
+	lcd16x2_puts(line);
 }
@@ -9,10 +9,20 @@
 /** Includes ---------------------------------------------------------------- */	
 #include "ds1307.h"
 
+/** Private variables ------------------------------------------------------- */
+// Local copy of the clock for cached mode, written only by the SQW handler
+// and ds1307_cache_sync(). Sequence changes on every update.
+static ds1307_datetime_t cache;
+static __IO uint32_t cacheSeq;
+// DelayGetMs() at the last seconds rollover
+static __IO uint32_t cacheEdgeMs;
+
 /** Private function prototypes --------------------------------------------- */
 uint8_t bcd2bin(uint8_t bcd);
 uint8_t bin2bcd(uint8_t bin);
 uint8_t check_min_max(uint8_t val, uint8_t min, uint8_t max);
+uint8_t days_in_month(uint8_t month, uint8_t year);
+void datetime_advance(ds1307_datetime_t* dt);
 
 /** Public functions -------------------------------------------------------- */
 /**
@@ -313,15 +323,26 @@ void ds1307_set_year(uint8_t year)
   * @param	Pointer to variable for store minutes value 
   * @param	Pointer to variable for store seconds value 
   * @param	Pointer to variable for store AM/PM value  
-  * @retval	None
+  * @retval	Status code (I2C_OK or I2C_ERR_xxx), outputs are unchanged
+  *					on error
   ******************************************************************************
   */
-void ds1307_get_time_12(uint8_t* hours, uint8_t* minutes, uint8_t* seconds, uint8_t* am_pm)
+uint8_t ds1307_get_time_12(uint8_t* hours, uint8_t* minutes, uint8_t* seconds, uint8_t* am_pm)
 {
-	*hours = ds1307_get_hours_12();
-	*minutes = ds1307_get_minutes();
-	*seconds = ds1307_get_seconds();
-	*am_pm = ds1307_get_am_pm();
+	ds1307_datetime_t dt;
+	uint8_t status;
+	
+	if ((status = ds1307_read_datetime(&dt)) != I2C_OK)
+	{
+		return status;
+	}
+	
+	*am_pm = (dt.hours >= 12) ? DS1307_PM : DS1307_AM;
+	*hours = (dt.hours % 12) ? (dt.hours % 12) : 12;
+	*minutes = dt.minutes;
+	*seconds = dt.seconds;
+	
+	return I2C_OK;
 }
 
 /**
@@ -349,14 +370,25 @@ void ds1307_set_time_12(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t
   * @param	Pointer to variable for store hours value
   * @param	Pointer to variable for store minutes value
   * @param	Pointer to variable for store seconds value
-  * @retval	None
+  * @retval	Status code (I2C_OK or I2C_ERR_xxx), outputs are unchanged
+  *					on error
   ******************************************************************************
   */
-void ds1307_get_time_24(uint8_t* hours, uint8_t* minutes, uint8_t* seconds)
+uint8_t ds1307_get_time_24(uint8_t* hours, uint8_t* minutes, uint8_t* seconds)
 {
-	*hours = ds1307_get_hours_24();
-	*minutes = ds1307_get_minutes();
-	*seconds = ds1307_get_seconds();
+	ds1307_datetime_t dt;
+	uint8_t status;
+	
+	if ((status = ds1307_read_datetime(&dt)) != I2C_OK)
+	{
+		return status;
+	}
+	
+	*hours = dt.hours;
+	*minutes = dt.minutes;
+	*seconds = dt.seconds;
+	
+	return I2C_OK;
 }
 
 /**
@@ -383,15 +415,26 @@ void ds1307_set_time_24(uint8_t hours, uint8_t minutes, uint8_t seconds)
   * @param	Pointer to variable for store date value
   * @param	Pointer to variable for store month value
   * @param	Pointer to variable for store year value
-  * @retval	None
+  * @retval	Status code (I2C_OK or I2C_ERR_xxx), outputs are unchanged
+  *					on error
   ******************************************************************************
   */
-void ds1307_get_calendar_date(uint8_t* day, uint8_t* date, uint8_t* month, uint8_t* year)
+uint8_t ds1307_get_calendar_date(uint8_t* day, uint8_t* date, uint8_t* month, uint8_t* year)
 {
-	*day = ds1307_get_day();
-	*date = ds1307_get_date();
-	*month = ds1307_get_month();
-	*year = ds1307_get_year();
+	ds1307_datetime_t dt;
+	uint8_t status;
+	
+	if ((status = ds1307_read_datetime(&dt)) != I2C_OK)
+	{
+		return status;
+	}
+	
+	*day = dt.day;
+	*date = dt.date;
+	*month = dt.month;
+	*year = dt.year;
+	
+	return I2C_OK;
 }
 
 /**
@@ -412,6 +455,197 @@ void ds1307_set_calendar_date(uint8_t day, uint8_t date, uint8_t month, uint8_t
 	ds1307_set_year(year);
 }
 
+/**
+  ******************************************************************************
+  *	@brief	Read all time registers in one burst (one I2C transaction)
+  * @param	Pointer to store date and time, hours in 24 hour mode
+  * @retval	I2C status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t ds1307_read_datetime(ds1307_datetime_t* dt)
+{
+	uint8_t reg[7];
+	uint8_t status;
+	
+	status = i2c_read_multi_with_reg(DS1307_DEVICE_ADDRESS, DS1307_SECONDS, 
+		sizeof(reg), reg);
+	if (status != I2C_OK)
+	{
+		return status;
+	}
+	
+	dt->seconds = bcd2bin(reg[DS1307_SECONDS] & 0x7F);
+	dt->minutes = bcd2bin(reg[DS1307_MINUTES]);
+	if (reg[DS1307_HOURS] & (1 << DS1307_HOUR_MODE))
+	{
+		// Convert 12 hour mode, 12 AM is 0 and 12 PM is 12
+		dt->hours = bcd2bin(reg[DS1307_HOURS] & 0x1F) % 12;
+		if (reg[DS1307_HOURS] & (1 << DS1307_AM_PM))
+		{
+			dt->hours += 12;
+		}
+	}
+	else
+	{
+		dt->hours = bcd2bin(reg[DS1307_HOURS] & 0x3F);
+	}
+	dt->day = bcd2bin(reg[DS1307_DAY]);
+	dt->date = bcd2bin(reg[DS1307_DATE]);
+	dt->month = bcd2bin(reg[DS1307_MONTH]);
+	dt->year = bcd2bin(reg[DS1307_YEAR]);
+	
+	return I2C_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Write all time registers in one burst (one I2C transaction). 
+  *					Sets 24 hour mode and starts the oscillator.
+  * @param	Pointer to date and time
+  * @retval	I2C status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t ds1307_write_datetime(const ds1307_datetime_t* dt)
+{
+	uint8_t reg[7];
+	
+	// Clock halt bit is clear
+	reg[DS1307_SECONDS] = bin2bcd(check_min_max(dt->seconds, 0, 59));
+	reg[DS1307_MINUTES] = bin2bcd(check_min_max(dt->minutes, 0, 59));
+	reg[DS1307_HOURS] = bin2bcd(check_min_max(dt->hours, 0, 23));
+	reg[DS1307_DAY] = bin2bcd(check_min_max(dt->day, 1, 7));
+	reg[DS1307_DATE] = bin2bcd(check_min_max(dt->date, 1, 31));
+	reg[DS1307_MONTH] = bin2bcd(check_min_max(dt->month, 1, 12));
+	reg[DS1307_YEAR] = bin2bcd(check_min_max(dt->year, 0, 99));
+	
+	return i2c_write_multi_with_reg(DS1307_DEVICE_ADDRESS, DS1307_SECONDS, 
+		reg, sizeof(reg));
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start cached mode: enable 1 Hz SQW output, load the local copy
+  *					from the chip, then advance it on every SQW falling edge
+  * @param	None
+  * @retval	I2C status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t ds1307_cache_init()
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	uint8_t status;
+	
+	status = i2c_write_with_reg(DS1307_DEVICE_ADDRESS, DS1307_CONTROL, 
+		DS1307_SQW_1HZ);
+	if (status != I2C_OK)
+	{
+		return status;
+	}
+	
+	// SQW/OUT is open drain, use internal pull-up
+	RCC_APB2PeriphClockCmd(DS1307_SQW_RCC | RCC_APB2Periph_AFIO, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = DS1307_SQW_PIN;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
+	GPIO_Init(DS1307_SQW_GPIO, &GPIO_InitStruct);
+	
+	// Route pin to its EXTI line, interrupt on falling edge (the DS1307
+	// seconds counter increments on the falling edge of the 1 Hz output)
+	AFIO->EXTICR[DS1307_SQW_LINE / 4] = 
+		(AFIO->EXTICR[DS1307_SQW_LINE / 4] & ~(0xF << ((DS1307_SQW_LINE % 4) * 4))) |
+		(DS1307_SQW_PORT << ((DS1307_SQW_LINE % 4) * 4));
+	EXTI->RTSR &= ~(1 << DS1307_SQW_LINE);
+	EXTI->FTSR |= (1 << DS1307_SQW_LINE);
+	EXTI->PR = (1 << DS1307_SQW_LINE);
+	EXTI->IMR |= (1 << DS1307_SQW_LINE);
+	
+	NVIC_InitStruct.NVIC_IRQChannel = DS1307_SQW_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 2;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+	
+	cacheEdgeMs = DelayGetMs();
+	return ds1307_cache_sync();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Reload the local copy from the chip, e.g. after setting the time
+  *					or periodically to be safe against a missed edge
+  * @param	None
+  * @retval	I2C status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t ds1307_cache_sync()
+{
+	ds1307_datetime_t dt;
+	uint8_t status;
+	
+	// SQW handler must not advance the copy while it is being replaced
+	NVIC_DisableIRQ(DS1307_SQW_IRQn);
+	status = ds1307_read_datetime(&dt);
+	if ((status == I2C_OK) && (EXTI->PR & (1 << DS1307_SQW_LINE)))
+	{
+		// Rollover happened before or during the read, it is unknown whether
+		// the read value includes it. Read again, now it does.
+		EXTI->PR = (1 << DS1307_SQW_LINE);
+		cacheEdgeMs = DelayGetMs();
+		status = ds1307_read_datetime(&dt);
+	}
+	if (status == I2C_OK)
+	{
+		cacheSeq++;
+		cache = dt;
+		cacheSeq++;
+	}
+	NVIC_EnableIRQ(DS1307_SQW_IRQn);
+	
+	return status;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get date and time from the local copy, no bus transaction
+  * @param	Pointer to store date and time, hours in 24 hour mode
+  * @retval	Milliseconds since the last seconds rollover (0 to 999)
+  ******************************************************************************
+  */
+uint16_t ds1307_get_cached(ds1307_datetime_t* dt)
+{
+	uint32_t seq;
+	uint32_t ms;
+	
+	// Copy again if the SQW handler updated it in the middle of the copy
+	do
+	{
+		seq = cacheSeq;
+		*dt = cache;
+		ms = DelayGetMs() - cacheEdgeMs;
+	} while (seq != cacheSeq);
+	
+	return (ms > 999) ? 999 : ms;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	SQW falling edge, the chip has just advanced by one second
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void DS1307_SQW_IRQHandler(void)
+{
+	if (EXTI->PR & (1 << DS1307_SQW_LINE))
+	{
+		EXTI->PR = (1 << DS1307_SQW_LINE);
+		cacheEdgeMs = DelayGetMs();
+		cacheSeq++;
+		datetime_advance(&cache);
+		cacheSeq++;
+	}
+}
+
 /** Private functions ------------------------------------------------------- */
 /**
   ******************************************************************************
@@ -462,5 +696,64 @@ uint8_t check_min_max(uint8_t val, uint8_t min, uint8_t max)
 	return val;
 }
 
+/**
+  ******************************************************************************
+  *	@brief	Get number of days in a month (year 00 to 99 is 2000 to 2099)
+  * @param	Month (1 to 12)
+  * @param	Year (0 to 99)
+  * @retval	Number of days
+  ******************************************************************************
+  */
+uint8_t days_in_month(uint8_t month, uint8_t year)
+{
+	static const uint8_t days[12] = 
+		{ 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	
+	if ((month == 2) && ((year % 4) == 0))
+	{
+		return 29;
+	}
+	
+	return days[check_min_max(month, 1, 12) - 1];
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Advance date and time by one second, the same way the chip does
+  * @param	Pointer to date and time
+  * @retval	None
+  ******************************************************************************
+  */
+void datetime_advance(ds1307_datetime_t* dt)
+{
+	if (++dt->seconds < 60)
+	{
+		return;
+	}
+	dt->seconds = 0;
+	if (++dt->minutes < 60)
+	{
+		return;
+	}
+	dt->minutes = 0;
+	if (++dt->hours < 24)
+	{
+		return;
+	}
+	dt->hours = 0;
+	dt->day = (dt->day % 7) + 1;
+	if (++dt->date <= days_in_month(dt->month, dt->year))
+	{
+		return;
+	}
+	dt->date = 1;
+	if (++dt->month <= 12)
+	{
+		return;
+	}
+	dt->month = 1;
+	dt->year = (dt->year + 1) % 100;
+}
+
 /********************************* END OF FILE ********************************/
 /******************************************************************************/
@@ -3,6 +3,11 @@
   * @file		ds1307.h
   * @author	Yohanes Erwin Setiawan
   * @date		9 March 2016
+	* @note		ds1307_read_datetime() and ds1307_write_datetime() access all
+	*					seven time registers in one burst, so fields can not tear across
+	*					a seconds rollover. In cached mode the 1 Hz SQW output of the
+	*					DS1307 advances a local copy from EXTI, ds1307_get_cached()
+	*					then reads the time without any bus transaction.
   ******************************************************************************
   */
 	
@@ -17,6 +22,8 @@ extern "C" {
 #include "stm32f10x.h"
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
+#include "misc.h"
+#include "delay.h"
 #include "i2c.h"	
 
 /** Defines ----------------------------------------------------------------- */
@@ -31,6 +38,22 @@ extern "C" {
 #define DS1307_DATE					0x04
 #define DS1307_MONTH				0x05
 #define DS1307_YEAR					0x06
+#define DS1307_CONTROL			0x07
+
+// Bits in seconds register
+#define DS1307_CLOCK_HALT		7
+
+// Control register value: SQWE set, RS1:RS0 = 00 (1 Hz square wave)
+#define DS1307_SQW_1HZ			0x10
+
+// SQW/OUT pin (open drain, internal pull-up is used) and its EXTI line
+#define DS1307_SQW_RCC			RCC_APB2Periph_GPIOB
+#define DS1307_SQW_GPIO			GPIOB
+#define DS1307_SQW_PIN			GPIO_Pin_0
+#define DS1307_SQW_PORT			1		// AFIO_EXTICR port source (0 = A, 1 = B)
+#define DS1307_SQW_LINE			0
+#define DS1307_SQW_IRQn			EXTI0_IRQn
+#define DS1307_SQW_IRQHandler	EXTI0_IRQHandler
 
 // Bits in hours register
 #define DS1307_HOUR_MODE		6
@@ -51,6 +74,19 @@ extern "C" {
 #define DS1307_FRIDAY				6
 #define DS1307_SATURDAY			7
 
+/** Typedefs ---------------------------------------------------------------- */
+// Snapshot of the time registers in decimal, hours always in 24 hour mode
+typedef struct ds1307_datetime
+{
+	uint8_t seconds;
+	uint8_t minutes;
+	uint8_t hours;
+	uint8_t day;
+	uint8_t date;
+	uint8_t month;
+	uint8_t year;
+} ds1307_datetime_t;
+
 /** Public function prototypes ---------------------------------------------- */
 void ds1307_init(void);
 uint8_t ds1307_get_seconds(void); 
@@ -71,12 +107,17 @@ uint8_t ds1307_get_month(void);
 void ds1307_set_month(uint8_t month);
 uint8_t ds1307_get_year(void);  
 void ds1307_set_year(uint8_t year);
-void ds1307_get_time_12(uint8_t* hours, uint8_t* minutes, uint8_t* seconds, uint8_t* am_pm);
+uint8_t ds1307_get_time_12(uint8_t* hours, uint8_t* minutes, uint8_t* seconds, uint8_t* am_pm);
 void ds1307_set_time_12(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t am_pm);
-void ds1307_get_time_24(uint8_t* hours, uint8_t* minutes, uint8_t* seconds);
+uint8_t ds1307_get_time_24(uint8_t* hours, uint8_t* minutes, uint8_t* seconds);
 void ds1307_set_time_24(uint8_t hours, uint8_t minutes, uint8_t seconds);
-void ds1307_get_calendar_date(uint8_t* day, uint8_t* date, uint8_t* month, uint8_t* year);
+uint8_t ds1307_get_calendar_date(uint8_t* day, uint8_t* date, uint8_t* month, uint8_t* year);
 void ds1307_set_calendar_date(uint8_t day, uint8_t date, uint8_t month, uint8_t year);
+uint8_t ds1307_read_datetime(ds1307_datetime_t* dt);
+uint8_t ds1307_write_datetime(const ds1307_datetime_t* dt);
+uint8_t ds1307_cache_init(void);
+uint8_t ds1307_cache_sync(void);
+uint16_t ds1307_get_cached(ds1307_datetime_t* dt);
 
 #ifdef __cplusplus
 }
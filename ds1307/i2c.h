@@ -3,6 +3,11 @@
   * @file		i2c.h
   * @author	Yohanes Erwin Setiawan
   * @date		9 March 2016
+	* @note		Every wait on the peripheral is bounded by I2C_TIMEOUT_US, a
+	*					failed transaction is retried I2C_RETRIES times and the bus is
+	*					recovered (9 SCL pulses) if a slave holds SDA low. Worst case
+	*					duration of a transaction with n data bytes is
+	*					I2C_WORST_CASE_US(n).
   ******************************************************************************
   */
 
@@ -18,6 +23,7 @@ extern "C" {
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
 #include "stm32f10x_i2c.h"
+#include "delay.h"
 
 /** Defines ----------------------------------------------------------------- */
 #define I2Cx_RCC				RCC_APB1Periph_I2C2
@@ -27,16 +33,56 @@ extern "C" {
 #define I2C_PIN_SDA			GPIO_Pin_11
 #define I2C_PIN_SCL			GPIO_Pin_10
 
+// Bus clock speed in Hz
+#define I2C_SPEED				100000
+// Max wait for one bus event (START, address, byte), about 10 byte times
+#define I2C_TIMEOUT_US	1000
+// Extra attempts after a failed transaction
+#define I2C_RETRIES			2
+// Bus recovery: 9 clock pulses, 5 us half period, plus a STOP condition
+#define I2C_RECOVERY_US	100
+// Upper bound in us for a transaction with n data bytes (including the
+// register byte): each phase waits for free bus, START, address and bytes,
+// a read with register has two phases
+#define I2C_WORST_CASE_US(n)	\
+	((uint32_t)((n) + 6) * I2C_TIMEOUT_US * (I2C_RETRIES + 1) + \
+	(I2C_RETRIES + 1) * I2C_RECOVERY_US)
+
+// Status codes
+#define I2C_OK					0
+#define I2C_ERR_BUSY		1		// Bus stays busy (slave holds SDA or SCL)
+#define I2C_ERR_START		2		// START condition not generated
+#define I2C_ERR_NACK		3		// Address not acknowledged
+#define I2C_ERR_TX			4		// Data byte not transmitted (timeout)
+#define I2C_ERR_RX			5		// Data byte not received
+#define I2C_ERR_ADDR		6		// Address phase timed out
+#define I2C_ERR_TX_NACK	7		// Data byte not acknowledged
+
+/** Typedefs ---------------------------------------------------------------- */
+// Per bus error and retry counters
+typedef struct
+{
+	uint32_t transactions;
+	uint32_t errors;					// Failed attempts
+	uint32_t timeouts;				// Failed attempts caused by a timeout
+	uint32_t nacks;						// Failed attempts caused by NACK
+	uint32_t retries;
+	uint32_t recoveries;			// Bus recovery sequences
+	uint32_t failures;				// Transactions failed after all retries
+} i2c_stats_t;
+
 /** Public function prototypes ---------------------------------------------- */
 void i2c_init(void);
-void i2c_write_no_reg(uint8_t address, uint8_t data);
-void i2c_write_with_reg(uint8_t address, uint8_t reg, uint8_t data);
-void i2c_write_multi_no_reg(uint8_t address, uint8_t* data, uint8_t len);
-void i2c_write_multi_with_reg(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len);
-void i2c_read_no_reg(uint8_t address, uint8_t* data);
-void i2c_read_with_reg(uint8_t address, uint8_t reg, uint8_t* data);
-void i2c_read_multi_no_reg(uint8_t address, uint8_t len, uint8_t* data);
-void i2c_read_multi_with_reg(uint8_t address, uint8_t reg, uint8_t len, uint8_t* data);
+uint8_t i2c_write_no_reg(uint8_t address, uint8_t data);
+uint8_t i2c_write_with_reg(uint8_t address, uint8_t reg, uint8_t data);
+uint8_t i2c_write_multi_no_reg(uint8_t address, uint8_t* data, uint8_t len);
+uint8_t i2c_write_multi_with_reg(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len);
+uint8_t i2c_read_no_reg(uint8_t address, uint8_t* data);
+uint8_t i2c_read_with_reg(uint8_t address, uint8_t reg, uint8_t* data);
+uint8_t i2c_read_multi_no_reg(uint8_t address, uint8_t len, uint8_t* data);
+uint8_t i2c_read_multi_with_reg(uint8_t address, uint8_t reg, uint8_t len, uint8_t* data);
+void i2c_bus_recovery(void);
+const i2c_stats_t* i2c_get_stats(void);
 
 #ifdef __cplusplus
 }
@@ -5,11 +5,24 @@
 #include "delay.h"
 #include "lcd16x2.h"
 #include "ds1307.h"
+#include "nvram.h"
 #include "i2c.h"
-#include <stdio.h>
+#include "fmt.h"
+#include "swtimer.h"
 
-uint8_t D, d, M, y, h, m, s;
-char buf[4];
+// NVRAM record keys
+#define KEY_CLOCK_SET		1
+#define KEY_BOOT_COUNT	2
+
+ds1307_datetime_t now;
+uint16_t boot_count;
+uint8_t clock_set;
+char line[LCD16X2_DISP_LENGTH + 1];
+swtimer_t refresh_timer;
+swtimer_t sync_timer;
+
+void refresh_display(void* arg);
+void sync_clock(void* arg);
 
 int main(void)
 {
@@ -19,39 +32,67 @@ int main(void)
 	// Initialize DS1307
 	ds1307_init();
 	
-	// Set initial date and time 
-	ds1307_set_calendar_date(DS1307_WEDNESDAY, 9, 3, 16);
-	ds1307_set_time_24(10, 10, 30);
+	// Settings are kept in the battery backed RAM of DS1307
+	nvram_init();
+	nvram_get(KEY_BOOT_COUNT, NVRAM_TYPE_U16, &boot_count, sizeof(boot_count));
+	boot_count++;
+	nvram_set(KEY_BOOT_COUNT, NVRAM_TYPE_U16, &boot_count, sizeof(boot_count));
+	
+	// Set initial date and time in one burst, only once. The clock keeps
+	// running on its battery after reset.
+	if (nvram_get(KEY_CLOCK_SET, NVRAM_TYPE_U8, &clock_set, 1) != NVRAM_OK)
+	{
+		now.day = DS1307_WEDNESDAY;
+		now.date = 9;
+		now.month = 3;
+		now.year = 16;
+		now.hours = 10;
+		now.minutes = 10;
+		now.seconds = 30;
+		ds1307_write_datetime(&now);
+		clock_set = 1;
+		nvram_set(KEY_CLOCK_SET, NVRAM_TYPE_U8, &clock_set, 1);
+	}
+	nvram_commit();
+	
+	// Follow the clock with the 1 Hz SQW output, reading it is then free
+	ds1307_cache_init();
+	
+	// Refresh date and time every 1 s without blocking the main loop
+	swtimer_init();
+	swtimer_create(&refresh_timer, refresh_display, 0);
+	swtimer_start(&refresh_timer, 0, 1000);
+	// Reload the cached clock from the chip once per hour
+	swtimer_create(&sync_timer, sync_clock, 0);
+	swtimer_start(&sync_timer, 3600000, 3600000);
 	
 	while (1)
 	{
-		// Get date and time
-		ds1307_get_calendar_date(&D, &d, &M, &y);
-		ds1307_get_time_24(&h, &m, &s);
-		
-		// Display date and time to LCD
-		lcd16x2_clrscr();
-		
-		lcd16x2_gotoxy(3, 0);
-		sprintf(buf, (d <= 9) ? "0%d" : "%d", d);
-		lcd16x2_puts(buf);
-		lcd16x2_puts("/");
-		sprintf(buf, (M <= 9) ? "0%d" : "%d", M);
-		lcd16x2_puts(buf);
-		lcd16x2_puts("/");
-		sprintf(buf, "20%d", y);
-		lcd16x2_puts(buf);
-		
-		lcd16x2_gotoxy(4, 1);
-		sprintf(buf, (h <= 9) ? "0%d" : "%d", h);
-		lcd16x2_puts(buf);
-		lcd16x2_puts(":");
-		sprintf(buf, (m <= 9) ? "0%d" : "%d", m);
-		lcd16x2_puts(buf);
-		lcd16x2_puts(":");
-		sprintf(buf, (s <= 9) ? "0%d" : "%d", s);
-		lcd16x2_puts(buf);
-		
-		DelayMs(1000);
+		swtimer_process();
+		// Sleep until the next timer is due or an interrupt occurs
+		DelayIdle(swtimer_idle_ms());
 	}
 }
+
+void refresh_display(void* arg)
+{
+	// Get date and time from the cached copy, no I2C transaction
+	ds1307_get_cached(&now);
+	
+	// Display date and time to LCD
+	// Every line is fully rewritten, so no need to clear the screen
+	fmt_line_init(line, LCD16X2_DISP_LENGTH);
+	fmt_date(&line[3], now.date, now.month, now.year);
+	lcd16x2_gotoxy(0, 0);
+	lcd16x2_puts(line);
+	
+	fmt_line_init(line, LCD16X2_DISP_LENGTH);
+	fmt_time(&line[4], now.hours, now.minutes, now.seconds);
+	lcd16x2_gotoxy(0, 1);
+	lcd16x2_puts(line);
+}
+
+void sync_clock(void* arg)
+{
+	ds1307_cache_sync();
+}
@@ -0,0 +1,364 @@
+/**
+  ******************************************************************************
+  * @file		nvram.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "nvram.h"
+#include <string.h>
+
+/** Private defines --------------------------------------------------------- */
+// Header bytes, stored after the records. A burst write lands in address
+// order, so a write cut by power loss never carries the new header.
+#define HDR_VERSION		(NVRAM_DATA_SIZE + 0)
+#define HDR_SEQUENCE	(NVRAM_DATA_SIZE + 1)
+#define HDR_LENGTH		(NVRAM_DATA_SIZE + 2)
+#define HDR_CRC				(NVRAM_DATA_SIZE + 3)
+
+// Record: key, tag (type << 4 | length), data
+#define REC_KEY				0
+#define REC_TAG				1
+#define REC_DATA			2
+
+/** Private variables ------------------------------------------------------- */
+// RAM image of the newest copy, records then header
+static uint8_t image[NVRAM_COPY_SIZE];
+static uint8_t* const records = image;
+// Copy index (0 or 1) the image was loaded from or last written to
+static uint8_t active;
+// Bytes used by records
+static uint8_t used;
+static uint8_t dirty;
+// Set once the store was read (or formatted), commit is refused before
+static uint8_t loaded;
+
+/** Private function prototypes --------------------------------------------- */
+static uint8_t nvram_crc8(const uint8_t* copy);
+static uint8_t nvram_valid(const uint8_t* copy);
+static int16_t nvram_find(uint8_t key);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Load the newest valid copy of the store from DS1307 RAM.
+  *					ds1307_init() must be called first.
+  * @param	None
+  * @retval	NVRAM_OK, NVRAM_EMPTY (no valid copy) or NVRAM_ERR_I2C
+  ******************************************************************************
+  */
+uint8_t nvram_init()
+{
+	uint8_t ram[NVRAM_SIZE];
+	uint8_t valid0, valid1;
+
+	// Both copies in one transaction
+	if (i2c_read_multi_with_reg(DS1307_DEVICE_ADDRESS, NVRAM_START, 
+		NVRAM_SIZE, ram) != I2C_OK)
+	{
+		// Do not overwrite a copy that could not be read
+		memset(image, 0, sizeof(image));
+		used = 0;
+		loaded = 0;
+		return NVRAM_ERR_I2C;
+	}
+
+	valid0 = nvram_valid(&ram[0]);
+	valid1 = nvram_valid(&ram[NVRAM_COPY_SIZE]);
+	if (!valid0 && !valid1)
+	{
+		nvram_format();
+		return NVRAM_EMPTY;
+	}
+
+	// Newer copy has the higher sequence number (modulo 256)
+	if (valid0 && valid1)
+	{
+		active = ((int8_t)(ram[NVRAM_COPY_SIZE + HDR_SEQUENCE] - 
+			ram[HDR_SEQUENCE]) > 0) ? 1 : 0;
+	}
+	else
+	{
+		active = valid1 ? 1 : 0;
+	}
+
+	memcpy(image, &ram[active * NVRAM_COPY_SIZE], NVRAM_COPY_SIZE);
+	used = image[HDR_LENGTH];
+	memset(&records[used], 0, NVRAM_DATA_SIZE - used);
+	dirty = 0;
+	loaded = 1;
+
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Read a record from the RAM image (no bus transaction)
+  * @param	Record key (1 to 255)
+  * @param	Expected record type (NVRAM_TYPE_xxx)
+  * @param	Pointer to store the value
+  * @param	Size of the value in bytes
+  * @retval	NVRAM_OK, NVRAM_NOT_FOUND or NVRAM_TYPE_MISMATCH
+  ******************************************************************************
+  */
+uint8_t nvram_get(uint8_t key, uint8_t type, void* data, uint8_t len)
+{
+	int16_t offset = nvram_find(key);
+
+	if (offset < 0)
+	{
+		return NVRAM_NOT_FOUND;
+	}
+	if (records[offset + REC_TAG] != ((type << 4) | len))
+	{
+		return NVRAM_TYPE_MISMATCH;
+	}
+
+	memcpy(data, &records[offset + REC_DATA], len);
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Add or change a record in the RAM image, nvram_commit() makes
+  *					the change persistent
+  * @param	Record key (1 to 255)
+  * @param	Record type (NVRAM_TYPE_xxx)
+  * @param	Pointer to the value
+  * @param	Size of the value in bytes (up to NVRAM_MAX_LEN)
+  * @retval	NVRAM_OK, NVRAM_FULL or NVRAM_TYPE_MISMATCH (invalid argument)
+  ******************************************************************************
+  */
+uint8_t nvram_set(uint8_t key, uint8_t type, const void* data, uint8_t len)
+{
+	uint8_t tag = (type << 4) | len;
+	uint8_t free = NVRAM_DATA_SIZE - used;
+	int16_t offset;
+
+	if ((key == NVRAM_KEY_END) || (len > NVRAM_MAX_LEN) || (type > 0x0F))
+	{
+		return NVRAM_TYPE_MISMATCH;
+	}
+
+	offset = nvram_find(key);
+	if ((offset >= 0) && (records[offset + REC_TAG] == tag))
+	{
+		// Same type and size, update in place
+		if (memcmp(&records[offset + REC_DATA], data, len) != 0)
+		{
+			memcpy(&records[offset + REC_DATA], data, len);
+			dirty = 1;
+		}
+		return NVRAM_OK;
+	}
+
+	// Check space first, the old record is kept if the new one does not fit
+	if (offset >= 0)
+	{
+		free += REC_DATA + (records[offset + REC_TAG] & 0x0F);
+	}
+	if ((REC_DATA + len) > free)
+	{
+		return NVRAM_FULL;
+	}
+	if (offset >= 0)
+	{
+		nvram_erase(key);
+	}
+
+	records[used + REC_KEY] = key;
+	records[used + REC_TAG] = tag;
+	memcpy(&records[used + REC_DATA], data, len);
+	used += REC_DATA + len;
+	dirty = 1;
+
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Remove a record from the RAM image
+  * @param	Record key
+  * @retval	NVRAM_OK or NVRAM_NOT_FOUND
+  ******************************************************************************
+  */
+uint8_t nvram_erase(uint8_t key)
+{
+	int16_t offset = nvram_find(key);
+	uint8_t size;
+
+	if (offset < 0)
+	{
+		return NVRAM_NOT_FOUND;
+	}
+
+	// Close the gap and clear the freed bytes at the end
+	size = REC_DATA + (records[offset + REC_TAG] & 0x0F);
+	memmove(&records[offset], &records[offset + size], used - offset - size);
+	used -= size;
+	memset(&records[used], 0, size);
+	dirty = 1;
+
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Write the RAM image over the older copy in one I2C transaction.
+  *					Does nothing if no record changed.
+  * @param	None
+  * @retval	NVRAM_OK or NVRAM_ERR_I2C (also if the store was not loaded)
+  ******************************************************************************
+  */
+uint8_t nvram_commit()
+{
+	uint8_t target = active ^ 1;
+
+	if (!loaded)
+	{
+		return NVRAM_ERR_I2C;
+	}
+	if (!dirty)
+	{
+		return NVRAM_OK;
+	}
+
+	image[HDR_VERSION] = NVRAM_VERSION;
+	image[HDR_SEQUENCE]++;
+	image[HDR_LENGTH] = used;
+	image[HDR_CRC] = nvram_crc8(image);
+
+	if (i2c_write_multi_with_reg(DS1307_DEVICE_ADDRESS, 
+		NVRAM_START + (target * NVRAM_COPY_SIZE), image, NVRAM_COPY_SIZE) != I2C_OK)
+	{
+		// Sequence is reused on the next attempt
+		image[HDR_SEQUENCE]--;
+		return NVRAM_ERR_I2C;
+	}
+
+	active = target;
+	dirty = 0;
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Clear all records in the RAM image, nvram_commit() makes it
+  *					persistent
+  * @param	None
+  * @retval	NVRAM_OK
+  ******************************************************************************
+  */
+uint8_t nvram_format()
+{
+	memset(image, 0, sizeof(image));
+	image[HDR_VERSION] = NVRAM_VERSION;
+	used = 0;
+	// First commit goes to copy 0
+	active = 1;
+	dirty = 1;
+	loaded = 1;
+
+	return NVRAM_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of record bytes in use
+  * @param	None
+  * @retval	Used bytes (up to NVRAM_DATA_SIZE)
+  ******************************************************************************
+  */
+uint8_t nvram_used()
+{
+	return used;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	CRC-8 (polynomial 0x07) over used records and header of a copy
+  * @param	Pointer to copy
+  * @retval	CRC value
+  ******************************************************************************
+  */
+static uint8_t nvram_crc8(const uint8_t* copy)
+{
+	uint8_t crc = 0;
+	uint8_t len = copy[HDR_LENGTH];
+	uint8_t i, bit;
+
+	// Records, then version, sequence and length
+	for (i = 0; i < (len + 3); i++)
+	{
+		crc ^= (i < len) ? copy[i] : copy[HDR_VERSION + i - len];
+		for (bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check header, CRC and record chain of a copy
+  * @param	Pointer to copy
+  * @retval	1 if valid, otherwise 0
+  ******************************************************************************
+  */
+static uint8_t nvram_valid(const uint8_t* copy)
+{
+	uint8_t len = copy[HDR_LENGTH];
+	uint8_t offset = 0;
+
+	if ((copy[HDR_VERSION] != NVRAM_VERSION) || (len > NVRAM_DATA_SIZE))
+	{
+		return 0;
+	}
+	if (nvram_crc8(copy) != copy[HDR_CRC])
+	{
+		return 0;
+	}
+
+	// Records must end exactly at the stored length
+	while ((offset + REC_DATA) <= len)
+	{
+		if (copy[offset + REC_KEY] == NVRAM_KEY_END)
+		{
+			return 0;
+		}
+		offset += REC_DATA + (copy[offset + REC_TAG] & 0x0F);
+	}
+
+	return offset == len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Find a record in the RAM image
+  * @param	Record key
+  * @retval	Offset of the record, -1 if not found
+  ******************************************************************************
+  */
+static int16_t nvram_find(uint8_t key)
+{
+	uint8_t offset = 0;
+
+	while ((offset + REC_DATA) <= used)
+	{
+		if (records[offset + REC_KEY] == key)
+		{
+			return offset;
+		}
+		offset += REC_DATA + (records[offset + REC_TAG] & 0x0F);
+	}
+
+	return -1;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
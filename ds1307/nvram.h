@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file		nvram.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Key-value store in the 56 byte battery backed RAM of DS1307.
+	*					The RAM holds two copies of the store, each with a header
+	*					(version, sequence, length, CRC-8) after its records.
+	*					nvram_commit() writes the older copy in a single I2C burst, so
+	*					power loss during a write always leaves the newest complete
+	*					copy intact.
+  ******************************************************************************
+  */
+
+#ifndef __NVRAM_H
+#define __NVRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "ds1307.h"
+
+/** Defines ----------------------------------------------------------------- */
+// DS1307 RAM location
+#define NVRAM_START					0x08
+#define NVRAM_SIZE					56
+// Two copies of the store, records then header
+#define NVRAM_COPY_SIZE			(NVRAM_SIZE / 2)
+#define NVRAM_HEADER_SIZE		4
+#define NVRAM_DATA_SIZE			(NVRAM_COPY_SIZE - NVRAM_HEADER_SIZE)
+// Layout version, stores with another version are ignored
+#define NVRAM_VERSION				0x01
+
+// Record types, stored in the upper nibble of the record tag byte
+// (data length in the lower nibble). Values are little endian.
+#define NVRAM_TYPE_U8				0x1
+#define NVRAM_TYPE_U16			0x2
+#define NVRAM_TYPE_U32			0x3
+#define NVRAM_TYPE_I16			0x4
+#define NVRAM_TYPE_I32			0x5
+#define NVRAM_TYPE_BLOB			0x6
+#define NVRAM_MAX_LEN				15
+
+// Key 0 marks the end of records
+#define NVRAM_KEY_END				0x00
+
+// Status codes
+#define NVRAM_OK						0
+#define NVRAM_EMPTY					1		// No valid copy found, store is empty
+#define NVRAM_NOT_FOUND			2
+#define NVRAM_TYPE_MISMATCH	3
+#define NVRAM_FULL					4
+#define NVRAM_ERR_I2C				5
+
+/** Public function prototypes ---------------------------------------------- */
+uint8_t nvram_init(void);
+uint8_t nvram_get(uint8_t key, uint8_t type, void* data, uint8_t len);
+uint8_t nvram_set(uint8_t key, uint8_t type, const void* data, uint8_t len);
+uint8_t nvram_erase(uint8_t key);
+uint8_t nvram_commit(void);
+uint8_t nvram_format(void);
+uint8_t nvram_used(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
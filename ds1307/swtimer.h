@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file		swtimer.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Hierarchical timer wheel with 1 ms resolution, driven by the
+	*					SysTick millisecond counter of the delay module. Start and stop
+	*					are O(1), callbacks are dispatched from swtimer_process() in the
+	*					main loop. Timers must only be started and stopped from the main
+	*					loop (including from callbacks), not from interrupt handlers.
+  ******************************************************************************
+  */
+
+#ifndef __SWTIMER_H
+#define __SWTIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "delay.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Wheel geometry: 5 levels of 32 slots cover 2^25 ms (about 9.3 hours).
+// Longer timeouts are parked in the last slot and re-inserted on cascade.
+#define SWTIMER_LEVELS			5
+#define SWTIMER_SLOT_BITS		5
+#define SWTIMER_SLOTS				(1 << SWTIMER_SLOT_BITS)
+#define SWTIMER_SLOT_MASK		(SWTIMER_SLOTS - 1)
+// Returned by swtimer_idle_ms() when no timer is running
+#define SWTIMER_NO_TIMEOUT	0xFFFFFFFF
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef void (*swtimer_callback_t)(void* arg);
+
+// Doubly linked list node, first member of every timer and slot head
+typedef struct swtimer_node
+{
+	struct swtimer_node* next;
+	struct swtimer_node* prev;
+} swtimer_node_t;
+
+typedef struct
+{
+	swtimer_node_t node;					// Must be first
+	uint32_t expires;							// Absolute expiry time in ms
+	uint32_t period;							// Reload period in ms, 0 = one-shot
+	swtimer_callback_t callback;
+	void* arg;
+} swtimer_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void swtimer_init(void);
+void swtimer_create(swtimer_t* timer, swtimer_callback_t callback, void* arg);
+void swtimer_start(swtimer_t* timer, uint32_t timeout_ms, uint32_t period_ms);
+void swtimer_stop(swtimer_t* timer);
+uint8_t swtimer_is_active(swtimer_t* timer);
+void swtimer_process(void);
+uint32_t swtimer_idle_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
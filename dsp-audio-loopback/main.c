@@ -25,7 +25,7 @@
 #include "stm32f10x_usart.h"
 #include "stm32f10x_tim.h"
 #include "delay.h"
-#include <stdio.h>
+#include "fmt.h"
 
 // If DEBUG = 1, then ADC value is sent to UART (for debugging)
 #define DEBUG		1
@@ -58,6 +58,8 @@ void TIM2_IRQHandler()
 
 int main(void)
 {
+	uint8_t len;
+	
 	// Initialize delay function
 	DelayInit();
 	
@@ -74,7 +76,9 @@ int main(void)
 		if (DEBUG)
 		{
 			// Send ADC value to UART for debugging
-			sprintf(sAdcValue, "%i\n", adcValue);
+			len = fmt_dec(sAdcValue, adcValue, 0, FMT_PAD_SPACE);
+			sAdcValue[len++] = '\n';
+			sAdcValue[len] = '\0';
 			UART_PutString(sAdcValue);
 			DelayMs(500);
 		}
@@ -3,6 +3,7 @@
 #include "stm32f10x_gpio.h"
 #include "stm32f10x_exti.h"
 #include "delay.h"
+#include "button.h"
 
 void EXTI15_10_Init(void);
 void wait(unsigned int nCount);
@@ -12,15 +13,9 @@ void EXTI15_10_IRQHandler(void)
 	// Checks whether the interrupt is from EXTI12 or not
 	if (EXTI_GetITStatus(EXTI_Line12))
 	{
-		// Blink LED on PB13 5 times
-		int i;
-		for (i = 0; i < 5; i++)
-		{
-			GPIOB->BSRR = GPIO_Pin_13;
-			wait(100);
-			GPIOB->BRR = GPIO_Pin_13;
-			wait(100);
-		}
+		// Contact bounce gives several edges per press, only restart the
+		// debounce tick here and let it decide
+		button_wake();
 		
 		// Clear pending bit
 		EXTI_ClearITPendingBit(EXTI_Line12);
@@ -28,11 +23,21 @@ void EXTI15_10_IRQHandler(void)
 }
 
 GPIO_InitTypeDef GPIO_InitStruct;
+button_event_t event;
 
 int main(void)
 {
+	uint32_t blinkTime, elapsed;
+	int i;
+	
 	DelayInit();
 	
+	// Set System Timer IRQ at higher priority than EXTI and button tick
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
+	// Debounce PB12, tick only runs after an edge until it settles
+	button_init(BUTTON_HI(GPIO_Pin_12), BUTTON_HI(GPIO_Pin_12));
+	button_sleep_when_idle(1);
 	// Initialize exernal interrupt
 	EXTI15_10_Init();
 	
@@ -49,13 +54,34 @@ int main(void)
 	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_Init(GPIOC, &GPIO_InitStruct);
 	
+	blinkTime = DelayGetMs();
 	while (1)
 	{
+		// Blink LED on PB13 5 times once per debounced press
+		while (button_get_event(&event))
+		{
+			if (event.type == BUTTON_EVENT_PRESS)
+			{
+				for (i = 0; i < 5; i++)
+				{
+					GPIOB->BSRR = GPIO_Pin_13;
+					wait(100);
+					GPIOB->BRR = GPIO_Pin_13;
+					wait(100);
+				}
+			}
+		}
+		
 		// Blink LED on PC13
-		GPIOC->BRR = GPIO_Pin_13;
-		DelayMs(1000);
-		GPIOC->BSRR = GPIO_Pin_13;
-		DelayMs(1000);
+		if ((DelayGetMs() - blinkTime) >= 1000)
+		{
+			blinkTime += 1000;
+			GPIOC->ODR ^= GPIO_Pin_13;
+		}
+		// The 5 blinks may have taken longer than the rest of the period
+		elapsed = DelayGetMs() - blinkTime;
+		DelayIdleUntil(button_event_pending, 
+			(elapsed < 1000) ? (1000 - elapsed) : 0);
 	}
 }
 
@@ -86,7 +112,7 @@ void EXTI15_10_Init()
 	
 	// Initialize NVIC for EXTI15_10 IRQ channel
 	NVIC_InitStruct.NVIC_IRQChannel = EXTI15_10_IRQn;
-	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 0x00;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 0x01;
 	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0x00;
 	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
 	NVIC_Init(&NVIC_InitStruct);
@@ -0,0 +1,340 @@
+/**
+  ******************************************************************************
+  * @file		compass.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "compass.h"
+
+/** Private defines --------------------------------------------------------- */
+// BKP data register n (1 to 10), 16-bit registers at 4 byte spacing
+#define BKP_DR(n)				(*(__IO uint16_t*)(BKP_BASE + (4 * (n))))
+#define BKP_REGS				8
+// Axis value reported by HMC5883L on ADC overflow
+#define AXIS_OVERFLOW		-4096
+
+/** Private variables ------------------------------------------------------- */
+// atan(2^-i) as Q15 fraction of pi
+static const uint16_t atanTable[COMPASS_CORDIC_ITERATIONS] = 
+{
+	8192, 4836, 2555, 1297, 651, 326, 163, 81, 41, 20, 10, 5, 3, 1, 1
+};
+
+static compass_cal_t cal = 
+{
+	{ 0, 0, 0 },
+	{ COMPASS_SCALE_ONE, COMPASS_SCALE_ONE, COMPASS_SCALE_ONE }
+};
+static int16_t calMin[3];
+static int16_t calMax[3];
+static uint16_t declination;
+
+/** Private function prototypes --------------------------------------------- */
+static void compass_bkp_enable(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Angle of vector (x, y) by CORDIC in vectoring mode
+  * @param	Y component
+  * @param	X component (|x| and |y| up to 2^29)
+  * @retval	Angle in Q15 fraction of pi (-32768 to 32767), 0 for (0, 0)
+  ******************************************************************************
+  */
+int16_t compass_atan2(int32_t y, int32_t x)
+{
+	uint16_t angle = 0;
+	uint32_t mag;
+	int32_t t;
+	uint8_t i;
+
+	if ((x == 0) && (y == 0))
+	{
+		return 0;
+	}
+
+	// Rotate by pi into the right half plane, CORDIC converges for
+	// angles up to about +-99 degrees
+	if (x < 0)
+	{
+		x = -x;
+		y = -y;
+		angle = 32768;
+	}
+
+	// Scale up for resolution, leave room for the CORDIC gain (1.65)
+	mag = (uint32_t)x | (uint32_t)((y < 0) ? -y : y);
+	while (mag < (1UL << 20))
+	{
+		x <<= 8;
+		y <<= 8;
+		mag <<= 8;
+	}
+	while (mag < (1UL << 28))
+	{
+		x <<= 1;
+		y <<= 1;
+		mag <<= 1;
+	}
+
+	// Rotate the vector onto the x axis, summing the rotation angles
+	for (i = 0; i < COMPASS_CORDIC_ITERATIONS; i++)
+	{
+		if (y > 0)
+		{
+			t = x + (y >> i);
+			y = y - (x >> i);
+			angle += atanTable[i];
+		}
+		else
+		{
+			t = x - (y >> i);
+			y = y + (x >> i);
+			angle -= atanTable[i];
+		}
+		x = t;
+	}
+
+	return (int16_t)angle;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Set magnetic declination added to every heading
+  * @param	Declination in tenths of degrees (east positive)
+  * @retval	None
+  ******************************************************************************
+  */
+void compass_set_declination(int16_t deg10)
+{
+	declination = (uint16_t)COMPASS_DEG10_TO_Q15(deg10);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Heading of a level sensor from a raw sample, with calibration
+  *					and declination applied
+  * @param	Raw X, Y, Z value
+  * @retval	Heading as Q16 fraction of a full turn (0 = north, 16384 = east),
+  *					use COMPASS_Q15_TO_DEG10() to get tenths of degrees
+  ******************************************************************************
+  */
+uint16_t compass_heading(int16_t x, int16_t y, int16_t z)
+{
+	compass_correct(&x, &y, &z);
+
+	// Q15 of pi equals Q16 of a full turn when taken unsigned
+	return (uint16_t)compass_atan2(y, x) + declination;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Apply hard iron offset and soft iron scale to a raw sample
+  * @param	Pointer to X, Y, Z value
+  * @retval	None
+  ******************************************************************************
+  */
+void compass_correct(int16_t* x, int16_t* y, int16_t* z)
+{
+	*x = (int16_t)(((int32_t)(*x - cal.offset[0]) * cal.scale[0]) >> 14);
+	*y = (int16_t)(((int32_t)(*y - cal.offset[1]) * cal.scale[1]) >> 14);
+	*z = (int16_t)(((int32_t)(*z - cal.offset[2]) * cal.scale[2]) >> 14);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start collecting min/max of each axis for calibration
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void compass_cal_start()
+{
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		calMin[i] = 32767;
+		calMax[i] = -32768;
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Add a raw sample to the calibration, call for every sample while
+  *					the sensor is turned around
+  * @param	Raw X, Y, Z value
+  * @retval	None
+  ******************************************************************************
+  */
+void compass_cal_update(int16_t x, int16_t y, int16_t z)
+{
+	int16_t v[3];
+	uint8_t i;
+
+	if ((x == AXIS_OVERFLOW) || (y == AXIS_OVERFLOW) || (z == AXIS_OVERFLOW))
+	{
+		return;
+	}
+
+	v[0] = x;
+	v[1] = y;
+	v[2] = z;
+	for (i = 0; i < 3; i++)
+	{
+		if (v[i] < calMin[i])
+		{
+			calMin[i] = v[i];
+		}
+		if (v[i] > calMax[i])
+		{
+			calMax[i] = v[i];
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Compute calibration from the collected min/max. The offset is the
+  *					center of each axis range, the scale makes every calibrated
+  *					axis range equal to their average. X and Y must have been
+  *					swept, Z is left uncalibrated if its range is too small.
+  * @param	None
+  * @retval	1 if the calibration was applied, 0 if X or Y range is too small
+  ******************************************************************************
+  */
+uint8_t compass_cal_finish()
+{
+	int32_t span[3];
+	int32_t sum = 0;
+	int32_t scale;
+	uint8_t axes = 0;
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		span[i] = (int32_t)calMax[i] - calMin[i];
+		if (span[i] >= COMPASS_CAL_MIN_SPAN)
+		{
+			sum += span[i];
+			axes++;
+		}
+		else if (i < 2)
+		{
+			return 0;
+		}
+	}
+
+	for (i = 0; i < axes; i++)
+	{
+		cal.offset[i] = (int16_t)(((int32_t)calMax[i] + calMin[i]) / 2);
+		scale = (sum * COMPASS_SCALE_ONE) / (axes * span[i]);
+		cal.scale[i] = (scale > 0xFFFF) ? 0xFFFF : (uint16_t)scale;
+	}
+	if (axes < 3)
+	{
+		cal.offset[2] = 0;
+		cal.scale[2] = COMPASS_SCALE_ONE;
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Load calibration from the BKP registers
+  * @param	None
+  * @retval	1 if a valid calibration was loaded, otherwise 0
+  ******************************************************************************
+  */
+uint8_t compass_cal_load()
+{
+	uint16_t regs[BKP_REGS];
+	uint16_t check = 0;
+	uint8_t i;
+
+	compass_bkp_enable();
+
+	for (i = 0; i < BKP_REGS; i++)
+	{
+		regs[i] = BKP_DR(COMPASS_BKP_FIRST + i);
+		check ^= regs[i];
+	}
+	// Check register makes the XOR of all registers zero
+	if ((regs[0] != COMPASS_BKP_MAGIC) || (check != 0))
+	{
+		return 0;
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		cal.offset[i] = (int16_t)regs[1 + i];
+		cal.scale[i] = regs[4 + i];
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Keep calibration in the BKP registers (retained on VBAT)
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void compass_cal_save()
+{
+	uint16_t regs[BKP_REGS];
+	uint16_t check = 0;
+	uint8_t i;
+
+	regs[0] = COMPASS_BKP_MAGIC;
+	for (i = 0; i < 3; i++)
+	{
+		regs[1 + i] = (uint16_t)cal.offset[i];
+		regs[4 + i] = cal.scale[i];
+	}
+	for (i = 0; i < (BKP_REGS - 1); i++)
+	{
+		check ^= regs[i];
+	}
+	regs[BKP_REGS - 1] = check;
+
+	compass_bkp_enable();
+	for (i = 0; i < BKP_REGS; i++)
+	{
+		BKP_DR(COMPASS_BKP_FIRST + i) = regs[i];
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get current calibration
+  * @param	None
+  * @retval	Pointer to calibration
+  ******************************************************************************
+  */
+const compass_cal_t* compass_get_cal()
+{
+	return &cal;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Enable BKP clock and write access to the backup domain
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void compass_bkp_enable()
+{
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+	PWR->CR |= PWR_CR_DBP;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
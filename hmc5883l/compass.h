@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file		compass.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Heading from magnetometer X/Y with an integer CORDIC atan2, no
+	*					floating point. Angles are Q15 fractions of pi (32768 = 180
+	*					degrees), so they wrap around naturally in int16_t/uint16_t.
+	*					Hard and soft iron calibration is found from the min/max of
+	*					each axis while the sensor is turned around, and is kept in
+	*					the battery backed BKP registers.
+  ******************************************************************************
+  */
+
+#ifndef __COMPASS_H
+#define __COMPASS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Number of CORDIC iterations, one bit of angle resolution each
+#define COMPASS_CORDIC_ITERATIONS	15
+
+// Angle conversion, Q15 angle to tenths of degrees and back
+#define COMPASS_DEG10_TO_Q15(d)		((int16_t)(((int32_t)(d) * 32768) / 1800))
+#define COMPASS_Q15_TO_DEG10(a)		((uint16_t)(((uint32_t)(uint16_t)(a) * 3600) >> 16))
+
+// Soft iron scale factor of 1.0
+#define COMPASS_SCALE_ONE					16384
+// Smallest axis span (max - min) accepted by compass_cal_finish()
+#define COMPASS_CAL_MIN_SPAN			100
+
+// First BKP data register used to keep the calibration (8 registers:
+// magic, offsets, scales, check)
+#define COMPASS_BKP_FIRST					1
+#define COMPASS_BKP_MAGIC					0xC0A1
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	int16_t offset[3];		// Hard iron offset of X, Y, Z
+	uint16_t scale[3];		// Soft iron scale of X, Y, Z (COMPASS_SCALE_ONE = 1.0)
+} compass_cal_t;
+
+/** Public function prototypes ---------------------------------------------- */
+int16_t compass_atan2(int32_t y, int32_t x);
+void compass_set_declination(int16_t deg10);
+uint16_t compass_heading(int16_t x, int16_t y, int16_t z);
+void compass_correct(int16_t* x, int16_t* y, int16_t* z);
+void compass_cal_start(void);
+void compass_cal_update(int16_t x, int16_t y, int16_t z);
+uint8_t compass_cal_finish(void);
+uint8_t compass_cal_load(void);
+void compass_cal_save(void);
+const compass_cal_t* compass_get_cal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,276 @@
+/**
+  ******************************************************************************
+  * @file		hmc5883l.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "hmc5883l.h"
+
+/** Private defines --------------------------------------------------------- */
+#define RING_MASK				(HMC5883L_RING_SIZE - 1)
+#define DRDY_BIT				(1 << HMC5883L_DRDY_LINE)
+// Max wait for a configuration write
+#define CONFIG_TIMEOUT_MS	10
+
+/** Private variables ------------------------------------------------------- */
+// Samples are written by the read completion (interrupt) and read by the
+// main loop. An entry is complete before head moves and is not reused
+// before tail moves past it.
+static hmc5883l_sample_t ring[HMC5883L_RING_SIZE];
+static __IO uint8_t ringHead;
+static __IO uint8_t ringTail;
+static __IO uint32_t dropped;
+
+// Burst read of the data output registers (X MSB, X LSB, Z MSB, Z LSB,
+// Y MSB, Y LSB). Reading all six also releases the register lock.
+static uint8_t rawValue[6];
+static i2c_request_t readRequest;
+static uint32_t readTime;
+// Mode register write that starts the next single measurement
+static const uint8_t singleMode = HMC5883L_SINGLE;
+static i2c_request_t triggerRequest;
+// Configuration registers A, B and mode written in one burst
+static uint8_t configValue[3];
+static i2c_request_t configRequest;
+static uint8_t mode;
+// Sensor on the shared bus, samples are served before other devices
+static i2c_device_t device = 
+{
+	HMC5883L_DEVICE_ADDRESS, I2C_BUS_PRIO_HIGH, I2C_SPEED_FAST, CONFIG_TIMEOUT_MS
+};
+
+/** Private function prototypes --------------------------------------------- */
+static void hmc5883l_read_done(i2c_xfer_t* xfer);
+static uint8_t hmc5883l_wait(i2c_xfer_t* xfer);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize DRDY interrupt and configure the sensor. The sensor
+  *					is a 400 kHz device on the shared bus, i2c_bus_init() must be
+  *					called first.
+  * @param	Pointer to configuration
+  * @retval	1 if the sensor was configured, otherwise 0
+  ******************************************************************************
+  */
+uint8_t hmc5883l_init(const hmc5883l_config_t* config)
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+
+	readRequest.device = &device;
+	readRequest.xfer.flags = I2C_XFER_REG;
+	readRequest.xfer.reg = HMC5883L_DATA_X_MSB;
+	readRequest.xfer.rx = rawValue;
+	readRequest.xfer.rx_len = sizeof(rawValue);
+	readRequest.callback = hmc5883l_read_done;
+
+	triggerRequest.device = &device;
+	triggerRequest.xfer.flags = I2C_XFER_REG;
+	triggerRequest.xfer.reg = HMC5883L_MODE;
+	triggerRequest.xfer.tx = &singleMode;
+	triggerRequest.xfer.tx_len = 1;
+
+	configRequest.device = &device;
+	configRequest.xfer.flags = I2C_XFER_REG;
+	configRequest.xfer.reg = HMC5883L_CFG_A;
+	configRequest.xfer.tx = configValue;
+	configRequest.xfer.tx_len = sizeof(configValue);
+
+	// DRDY is open drain, use internal pull-up
+	RCC_APB2PeriphClockCmd(HMC5883L_DRDY_RCC | RCC_APB2Periph_AFIO, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = HMC5883L_DRDY_PIN;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
+	GPIO_Init(HMC5883L_DRDY_GPIO, &GPIO_InitStruct);
+
+	// Route pin to its EXTI line, DRDY goes low when new data is ready
+	AFIO->EXTICR[HMC5883L_DRDY_LINE / 4] = 
+		(AFIO->EXTICR[HMC5883L_DRDY_LINE / 4] & ~(0xF << ((HMC5883L_DRDY_LINE % 4) * 4))) |
+		(HMC5883L_DRDY_PORT << ((HMC5883L_DRDY_LINE % 4) * 4));
+	EXTI->RTSR &= ~DRDY_BIT;
+	EXTI->FTSR |= DRDY_BIT;
+
+	// Lower priority than I2C, so a read is never queued from inside
+	// the completion of the previous one
+	NVIC_InitStruct.NVIC_IRQChannel = HMC5883L_DRDY_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 2;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+
+	return hmc5883l_configure(config);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Change output rate, averaging, gain and mode, then restart sampling
+  * @param	Pointer to configuration
+  * @retval	1 if the sensor was configured, otherwise 0
+  ******************************************************************************
+  */
+uint8_t hmc5883l_configure(const hmc5883l_config_t* config)
+{
+	uint8_t ok;
+
+	// Stop sampling and let the running read finish
+	EXTI->IMR &= ~DRDY_BIT;
+	hmc5883l_wait(&readRequest.xfer);
+	hmc5883l_wait(&triggerRequest.xfer);
+
+	configValue[0] = ((config->average & 0x03) << 5) | ((config->rate & 0x07) << 2);
+	configValue[1] = (config->gain & 0x07) << 5;
+	configValue[2] = config->mode & 0x03;
+	i2c_bus_submit(&configRequest);
+	ok = hmc5883l_wait(&configRequest.xfer);
+	mode = config->mode;
+
+	// Drop samples taken with the old configuration
+	ringTail = ringHead;
+
+	// In continuous mode DRDY may already be low, start with one read
+	// by software. A single measurement was started by the mode write.
+	EXTI->PR = DRDY_BIT;
+	EXTI->IMR |= DRDY_BIT;
+	if (mode == HMC5883L_CONTINUOUS)
+	{
+		EXTI->SWIER = DRDY_BIT;
+	}
+
+	return ok;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Take the oldest sample from the ring buffer
+  * @param	Pointer to store the sample
+  * @retval	1 if a sample was read, 0 if the buffer is empty
+  ******************************************************************************
+  */
+uint8_t hmc5883l_read(hmc5883l_sample_t* sample)
+{
+	uint8_t tail = ringTail;
+
+	if (tail == ringHead)
+	{
+		return 0;
+	}
+
+	// Copy before releasing the entry to the producer
+	*sample = ring[tail & RING_MASK];
+	ringTail = tail + 1;
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of samples in the ring buffer
+  * @param	None
+  * @retval	Number of samples
+  ******************************************************************************
+  */
+uint8_t hmc5883l_available()
+{
+	return (uint8_t)(ringHead - ringTail);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of samples lost (read still running at the next DRDY,
+  *					bus error or ring buffer full)
+  * @param	None
+  * @retval	Number of samples lost
+  ******************************************************************************
+  */
+uint32_t hmc5883l_dropped()
+{
+	return dropped;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	DRDY falling edge, queue the burst read of the new sample
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void HMC5883L_DRDY_IRQHandler(void)
+{
+	if (EXTI->PR & DRDY_BIT)
+	{
+		EXTI->PR = DRDY_BIT;
+
+		if ((readRequest.xfer.status == I2C_XFER_QUEUED) || 
+			(readRequest.xfer.status == I2C_XFER_BUSY))
+		{
+			dropped++;
+			return;
+		}
+
+		readTime = (uint32_t) DelayGetUs();
+		i2c_bus_submit(&readRequest);
+		if (mode == HMC5883L_SINGLE)
+		{
+			// Next measurement starts after this read
+			i2c_bus_submit(&triggerRequest);
+		}
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Burst read finished (interrupt context), store the sample
+  * @param	Read transfer
+  * @retval	None
+  ******************************************************************************
+  */
+static void hmc5883l_read_done(i2c_xfer_t* xfer)
+{
+	uint8_t head = ringHead;
+	hmc5883l_sample_t* sample;
+
+	if ((xfer->status != I2C_XFER_DONE) || 
+		((uint8_t)(head - ringTail) >= HMC5883L_RING_SIZE))
+	{
+		dropped++;
+		return;
+	}
+
+	sample = &ring[head & RING_MASK];
+	sample->time_us = readTime;
+	sample->x = (int16_t)((rawValue[0] << 8) | rawValue[1]);
+	sample->z = (int16_t)((rawValue[2] << 8) | rawValue[3]);
+	sample->y = (int16_t)((rawValue[4] << 8) | rawValue[5]);
+
+	// Publish the complete entry
+	ringHead = head + 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Wait until a transfer is no longer queued or running
+  * @param	Transfer
+  * @retval	1 if the transfer completed successfully, otherwise 0
+  ******************************************************************************
+  */
+static uint8_t hmc5883l_wait(i2c_xfer_t* xfer)
+{
+	uint32_t start = DelayGetMs();
+
+	while ((xfer->status == I2C_XFER_QUEUED) || (xfer->status == I2C_XFER_BUSY))
+	{
+		if ((DelayGetMs() - start) > CONFIG_TIMEOUT_MS)
+		{
+			return 0;
+		}
+	}
+
+	return xfer->status == I2C_XFER_DONE;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file		hmc5883l.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		HMC5883L magnetometer sampled on its DRDY pin. The falling edge
+	*					of DRDY queues an asynchronous 6 byte burst read (i2c_bus),
+	*					its completion stores a timestamped sample in a ring buffer
+	*					that the main loop drains with hmc5883l_read().
+  ******************************************************************************
+  */
+
+#ifndef __HMC5883L_H
+#define __HMC5883L_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "misc.h"
+#include "delay.h"
+#include "i2c.h"
+#include "i2c_bus.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Slave address for HMC5883L chip (7-bit format)
+#define HMC5883L_DEVICE_ADDRESS		0x1E
+
+// Register location
+#define HMC5883L_CFG_A						0x00
+#define HMC5883L_CFG_B						0x01
+#define HMC5883L_MODE							0x02
+#define HMC5883L_DATA_X_MSB				0x03
+#define HMC5883L_STATUS						0x09
+
+// Output rate in continuous mode (configuration register A, DO2:DO0)
+#define HMC5883L_RATE_0_75HZ			0
+#define HMC5883L_RATE_1_5HZ				1
+#define HMC5883L_RATE_3HZ					2
+#define HMC5883L_RATE_7_5HZ				3
+#define HMC5883L_RATE_15HZ				4
+#define HMC5883L_RATE_30HZ				5
+#define HMC5883L_RATE_75HZ				6
+
+// Samples averaged per output (configuration register A, MA1:MA0)
+#define HMC5883L_AVERAGE_1				0
+#define HMC5883L_AVERAGE_2				1
+#define HMC5883L_AVERAGE_4				2
+#define HMC5883L_AVERAGE_8				3
+
+// Gain (configuration register B, GN2:GN0), full scale in gauss
+#define HMC5883L_GAIN_0_88GA			0
+#define HMC5883L_GAIN_1_3GA				1
+#define HMC5883L_GAIN_1_9GA				2
+#define HMC5883L_GAIN_2_5GA				3
+#define HMC5883L_GAIN_4_0GA				4
+#define HMC5883L_GAIN_4_7GA				5
+#define HMC5883L_GAIN_5_6GA				6
+#define HMC5883L_GAIN_8_1GA				7
+
+// Measurement mode (mode register). In single mode the next measurement
+// is started right after each read, up to 160 Hz with averaging 1.
+#define HMC5883L_CONTINUOUS				0
+#define HMC5883L_SINGLE						1
+#define HMC5883L_IDLE							2
+
+// Value of an axis when the ADC overflowed
+#define HMC5883L_OVERFLOW					-4096
+
+// DRDY pin (open drain, active low) and its EXTI line
+#define HMC5883L_DRDY_RCC					RCC_APB2Periph_GPIOB
+#define HMC5883L_DRDY_GPIO				GPIOB
+#define HMC5883L_DRDY_PIN					GPIO_Pin_1
+#define HMC5883L_DRDY_PORT				1		// AFIO_EXTICR port source (0 = A, 1 = B)
+#define HMC5883L_DRDY_LINE				1
+#define HMC5883L_DRDY_IRQn				EXTI1_IRQn
+#define HMC5883L_DRDY_IRQHandler	EXTI1_IRQHandler
+
+// Ring buffer size, must be power of 2
+#define HMC5883L_RING_SIZE				16
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint8_t rate;
+	uint8_t average;
+	uint8_t gain;
+	uint8_t mode;
+} hmc5883l_config_t;
+
+typedef struct
+{
+	uint32_t time_us;		// DelayGetUs() at the DRDY edge (lower 32 bits)
+	int16_t x;
+	int16_t y;
+	int16_t z;
+} hmc5883l_sample_t;
+
+/** Public function prototypes ---------------------------------------------- */
+uint8_t hmc5883l_init(const hmc5883l_config_t* config);
+uint8_t hmc5883l_configure(const hmc5883l_config_t* config);
+uint8_t hmc5883l_read(hmc5883l_sample_t* sample);
+uint8_t hmc5883l_available(void);
+uint32_t hmc5883l_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
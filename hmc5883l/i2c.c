@@ -9,13 +9,29 @@
 /** Includes ---------------------------------------------------------------- */	
 #include "i2c.h"
 
+/** Private defines --------------------------------------------------------- */
+// Result of i2c_wait_event()
+#define I2C_WAIT_OK				0
+#define I2C_WAIT_NACK			1
+#define I2C_WAIT_TIMEOUT	2
+
+/** Private variables ------------------------------------------------------- */
+// I2C_TIMEOUT_US converted to core clock cycles
+static uint32_t timeoutCycles;
+static i2c_stats_t stats;
+
 /** Private function prototypes --------------------------------------------- */
-void i2c_start(void);
+uint8_t i2c_transaction(uint8_t address, const uint8_t* reg, 
+	const uint8_t* tx, uint8_t tx_len, uint8_t* rx, uint8_t rx_len);
+uint8_t i2c_attempt(uint8_t address, const uint8_t* reg, 
+	const uint8_t* tx, uint8_t tx_len, uint8_t* rx, uint8_t rx_len);
+uint8_t i2c_wait_event(uint32_t event);
+uint8_t i2c_start(void);
 void i2c_stop(void);
-void i2c_address_direction(uint8_t address, uint8_t direction);
-void i2c_transmit(uint8_t byte);
-uint8_t i2c_receive_ack(void);
-uint8_t i2c_receive_nack(void);
+uint8_t i2c_address_direction(uint8_t address, uint8_t direction);
+uint8_t i2c_transmit(uint8_t byte);
+uint8_t i2c_receive_ack(uint8_t* byte);
+uint8_t i2c_receive_nack(uint8_t* byte);
 
 /** Public functions -------------------------------------------------------- */
 /**
@@ -33,7 +49,7 @@ void i2c_init()
 	
 	// Step 1: Initialize I2C
 	RCC_APB1PeriphClockCmd(I2Cx_RCC, ENABLE);
-	I2C_InitStruct.I2C_ClockSpeed = 100000;
+	I2C_InitStruct.I2C_ClockSpeed = I2C_SPEED;
 	I2C_InitStruct.I2C_Mode = I2C_Mode_I2C;
 	I2C_InitStruct.I2C_DutyCycle = I2C_DutyCycle_2;
 	I2C_InitStruct.I2C_OwnAddress1 = 0x00;
@@ -48,6 +64,8 @@ void i2c_init()
 	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_OD;
 	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
 	GPIO_Init(I2C_GPIO, &GPIO_InitStruct);
+	
+	timeoutCycles = (SystemCoreClock / 1000000) * I2C_TIMEOUT_US;
 }
 
 /**
@@ -55,15 +73,12 @@ void i2c_init()
   *	@brief	Write byte to slave without specify register address
   * @param	Slave device address (7-bit right aligned)
   * @param	Data byte
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_write_no_reg(uint8_t address, uint8_t data)
+uint8_t i2c_write_no_reg(uint8_t address, uint8_t data)
 {
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	i2c_transmit(data);
-	i2c_stop();
+	return i2c_transaction(address, 0, &data, 1, 0, 0);
 }
 
 /**
@@ -72,16 +87,12 @@ void i2c_write_no_reg(uint8_t address, uint8_t data)
   * @param	Slave device address (7-bit right aligned)
   * @param	Register address
   * @param	Data byte
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_write_with_reg(uint8_t address, uint8_t reg, uint8_t data)
+uint8_t i2c_write_with_reg(uint8_t address, uint8_t reg, uint8_t data)
 {
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	i2c_transmit(reg);
-	i2c_transmit(data);
-	i2c_stop();
+	return i2c_transaction(address, &reg, &data, 1, 0, 0);
 }
 
 /**
@@ -91,20 +102,12 @@ void i2c_write_with_reg(uint8_t address, uint8_t reg, uint8_t data)
   * @param	Slave device address (7-bit right aligned)
   * @param	Pointer to data byte array
   * @param	Number of bytes to write
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_write_multi_no_reg(uint8_t address, uint8_t* data, uint8_t len)
+uint8_t i2c_write_multi_no_reg(uint8_t address, uint8_t* data, uint8_t len)
 {
-	int i;
-	
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	for (i = 0; i < len; i++)
-	{
-		i2c_transmit(data[i]);
-	}
-	i2c_stop();
+	return i2c_transaction(address, 0, data, len, 0, 0);
 }
 
 /**
@@ -115,21 +118,12 @@ void i2c_write_multi_no_reg(uint8_t address, uint8_t* data, uint8_t len)
   * @param	Register address where to start write
   * @param	Pointer to data byte array
   * @param	Number of bytes to write
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_write_multi_with_reg(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len)
+uint8_t i2c_write_multi_with_reg(uint8_t address, uint8_t reg, uint8_t* data, uint8_t len)
 {
-	int i;
-	
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	i2c_transmit(reg);
-	for (i = 0; i < len; i++)
-	{
-		i2c_transmit(data[i]);
-	}
-	i2c_stop();
+	return i2c_transaction(address, &reg, data, len, 0, 0);
 }
 
 /**
@@ -137,15 +131,12 @@ void i2c_write_multi_with_reg(uint8_t address, uint8_t reg, uint8_t* data, uint8
   *	@brief	Read byte from slave without specify register address
   * @param	Slave device address (7-bit right aligned)
   * @param	Pointer to data byte to store data from slave
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_read_no_reg(uint8_t address, uint8_t* data)
+uint8_t i2c_read_no_reg(uint8_t address, uint8_t* data)
 {
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Receiver);
-	*data = i2c_receive_nack();
-	i2c_stop();
+	return i2c_transaction(address, 0, 0, 0, data, 1);
 }
 
 /**
@@ -154,19 +145,12 @@ void i2c_read_no_reg(uint8_t address, uint8_t* data)
   * @param	Slave device address (7-bit right aligned)
   * @param	Register address
   * @param	Pointer to data byte to store data from slave
-  * @retval	None
+  * @retval	Status code (I2C_OK on success)
   ******************************************************************************
   */
-void i2c_read_with_reg(uint8_t address, uint8_t reg, uint8_t* data)
+uint8_t i2c_read_with_reg(uint8_t address, uint8_t reg, uint8_t* data)
 {
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	i2c_transmit(reg);
-	i2c_stop();
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Receiver);
-	*data = i2c_receive_nack();
-	i2c_stop();
+	return i2c_transaction(address, &reg, 0, 0, data, 1);
 }
 
 /**
@@ -175,75 +159,264 @@ void i2c_read_with_reg(uint8_t address, uint8_t reg, uint8_t* data)
   * @param	Slave device address (7-bit right aligned)
   * @param	Number of data bytes to read from slave 
   * @param	Pointer to data array byte to store data from slave
+  * @retval	Status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t i2c_read_multi_no_reg(uint8_t address, uint8_t len, uint8_t* data)
+{
+	return i2c_transaction(address, 0, 0, 0, data, len);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Read bytes from slave with specify register address
+  * @param	Slave device address (7-bit right aligned)
+  * @param	Register address
+  * @param	Number of data bytes to read from slave 
+  * @param	Pointer to data array byte to store data from slave
+  * @retval	Status code (I2C_OK on success)
+  ******************************************************************************
+  */
+uint8_t i2c_read_multi_with_reg(uint8_t address, uint8_t reg, uint8_t len, uint8_t* data)
+{
+	return i2c_transaction(address, &reg, 0, 0, data, len);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Free a bus that is held by a slave stuck in the middle of a read.
+  *					Clock out 9 SCL pulses by GPIO, generate STOP, then re-init
+  *					the I2C peripheral.
+  * @param	None
   * @retval	None
   ******************************************************************************
   */
-void i2c_read_multi_no_reg(uint8_t address, uint8_t len, uint8_t* data)
+void i2c_bus_recovery()
 {
-	int i;
+	GPIO_InitTypeDef GPIO_InitStruct;
+	uint8_t i;
+	
+	stats.recoveries++;
 	
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Receiver);
-	for (i = 0; i < len; i++)
+	// Take the pins from the peripheral, both released (high)
+	I2C_Cmd(I2Cx, DISABLE);
+	GPIO_SetBits(I2C_GPIO, I2C_PIN_SCL | I2C_PIN_SDA);
+	GPIO_InitStruct.GPIO_Pin = I2C_PIN_SCL | I2C_PIN_SDA;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_OD;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(I2C_GPIO, &GPIO_InitStruct);
+	
+	// Up to 9 clocks let the slave finish the byte it is sending,
+	// it releases SDA when the master would send NACK
+	for (i = 0; i < 9; i++)
 	{
-		if (i == (len - 1))
+		if (GPIO_ReadInputDataBit(I2C_GPIO, I2C_PIN_SDA))
 		{
-			data[i] = i2c_receive_nack();
+			break;
+		}
+		GPIO_ResetBits(I2C_GPIO, I2C_PIN_SCL);
+		DelayUs(5);
+		GPIO_SetBits(I2C_GPIO, I2C_PIN_SCL);
+		DelayUs(5);
+	}
+	
+	// STOP condition: SDA low to high while SCL is high
+	GPIO_ResetBits(I2C_GPIO, I2C_PIN_SDA);
+	DelayUs(5);
+	GPIO_SetBits(I2C_GPIO, I2C_PIN_SDA);
+	DelayUs(5);
+	
+	// Reset peripheral to clear its BUSY flag, then configure it again
+	I2C_SoftwareResetCmd(I2Cx, ENABLE);
+	I2C_SoftwareResetCmd(I2Cx, DISABLE);
+	i2c_init();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get error and retry counters of the bus
+  * @param	None
+  * @retval	Pointer to counters
+  ******************************************************************************
+  */
+const i2c_stats_t* i2c_get_stats()
+{
+	return &stats;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Run a transaction, retry on failure and recover the bus if it
+  *					stays busy
+  * @param	Slave device address (7-bit right aligned)
+  * @param	Pointer to register address (0 = no register)
+  * @param	Data bytes to write
+  * @param	Number of bytes to write
+  * @param	Buffer for data bytes read from slave
+  * @param	Number of bytes to read
+  * @retval	Status code of the last attempt
+  ******************************************************************************
+  */
+uint8_t i2c_transaction(uint8_t address, const uint8_t* reg, 
+	const uint8_t* tx, uint8_t tx_len, uint8_t* rx, uint8_t rx_len)
+{
+	uint8_t status;
+	uint8_t attempt = 0;
+	
+	stats.transactions++;
+	while (1)
+	{
+		status = i2c_attempt(address, reg, tx, tx_len, rx, rx_len);
+		if (status == I2C_OK)
+		{
+			return I2C_OK;
+		}
+		
+		stats.errors++;
+		if ((status == I2C_ERR_NACK) || (status == I2C_ERR_TX_NACK))
+		{
+			stats.nacks++;
 		}
 		else
 		{
-			data[i] = i2c_receive_ack();
+			stats.timeouts++;
+		}
+		
+		// Release the bus, then recover it if it is still held
+		i2c_stop();
+		if ((status == I2C_ERR_BUSY) || (status == I2C_ERR_START) ||
+			(status == I2C_ERR_ADDR) || (status == I2C_ERR_RX))
+		{
+			i2c_bus_recovery();
 		}
+		
+		if (attempt++ == I2C_RETRIES)
+		{
+			stats.failures++;
+			return status;
+		}
+		stats.retries++;
 	}
-	i2c_stop();
 }
 
 /**
   ******************************************************************************
-  *	@brief	Read bytes from slave with specify register address
-  * @param	Slave device address (7-bit right aligned)
-  * @param	Register address
-  * @param	Number of data bytes to read from slave 
-  * @param	Pointer to data array byte to store data from slave
-  * @retval	None
+  *	@brief	One attempt of a transaction: [write reg and tx] [read rx]
+  * @param	Same as i2c_transaction()
+  * @retval	Status code
   ******************************************************************************
   */
-void i2c_read_multi_with_reg(uint8_t address, uint8_t reg, uint8_t len, uint8_t* data)
+uint8_t i2c_attempt(uint8_t address, const uint8_t* reg, 
+	const uint8_t* tx, uint8_t tx_len, uint8_t* rx, uint8_t rx_len)
 {
-	int i;
+	uint8_t status;
+	uint8_t i;
 	
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
-	i2c_transmit(reg);
-	i2c_stop();
-	i2c_start();
-	i2c_address_direction(address << 1, I2C_Direction_Receiver);
-	for (i = 0; i < len; i++)
+	if (reg || tx_len)
 	{
-		if (i == (len - 1))
+		if ((status = i2c_start()) != I2C_OK)
 		{
-			data[i] = i2c_receive_nack();
+			return status;
 		}
-		else
+		if ((status = i2c_address_direction(address << 1, 
+			I2C_Direction_Transmitter)) != I2C_OK)
 		{
-			data[i] = i2c_receive_ack();
+			return status;
 		}
+		if (reg && ((status = i2c_transmit(*reg)) != I2C_OK))
+		{
+			return status;
+		}
+		for (i = 0; i < tx_len; i++)
+		{
+			if ((status = i2c_transmit(tx[i])) != I2C_OK)
+			{
+				return status;
+			}
+		}
+		i2c_stop();
 	}
-	i2c_stop();
+	
+	if (rx_len)
+	{
+		if ((status = i2c_start()) != I2C_OK)
+		{
+			return status;
+		}
+		if ((status = i2c_address_direction(address << 1, 
+			I2C_Direction_Receiver)) != I2C_OK)
+		{
+			return status;
+		}
+		for (i = 0; i < rx_len; i++)
+		{
+			if (i == (rx_len - 1))
+			{
+				status = i2c_receive_nack(&rx[i]);
+			}
+			else
+			{
+				status = i2c_receive_ack(&rx[i]);
+			}
+			if (status != I2C_OK)
+			{
+				return status;
+			}
+		}
+		i2c_stop();
+	}
+	
+	return I2C_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Wait for an I2C event with timeout
+  * @param	I2C event (I2C_EVENT_xxx)
+  * @retval	I2C_WAIT_OK, I2C_WAIT_NACK or I2C_WAIT_TIMEOUT
+  ******************************************************************************
+  */
+uint8_t i2c_wait_event(uint32_t event)
+{
+	uint32_t start = DelayGetCycles();
+	
+	while (!I2C_CheckEvent(I2Cx, event))
+	{
+		// Slave did not acknowledge, no point waiting any longer
+		if (I2C_GetFlagStatus(I2Cx, I2C_FLAG_AF))
+		{
+			I2C_ClearFlag(I2Cx, I2C_FLAG_AF);
+			return I2C_WAIT_NACK;
+		}
+		if ((DelayGetCycles() - start) > timeoutCycles)
+		{
+			return I2C_WAIT_TIMEOUT;
+		}
+	}
+	
+	return I2C_WAIT_OK;
 }
 
-/** Private functions ------------------------------------------------------- */
 /**
   ******************************************************************************
   *	@brief	Generate I2C start condition
   * @param	None
-  * @retval	None
+  * @retval	Status code
   ******************************************************************************
   */
-void i2c_start()
+uint8_t i2c_start()
 {
+	uint32_t start = DelayGetCycles();
+	
 	// Wait until I2Cx is not busy anymore
-	while (I2C_GetFlagStatus(I2Cx, I2C_FLAG_BUSY));
+	while (I2C_GetFlagStatus(I2Cx, I2C_FLAG_BUSY))
+	{
+		if ((DelayGetCycles() - start) > timeoutCycles)
+		{
+			return I2C_ERR_BUSY;
+		}
+	}
 	
 	// Generate start condition
 	I2C_GenerateSTART(I2Cx, ENABLE);
@@ -251,7 +424,12 @@ void i2c_start()
 	// Wait for I2C EV5. 
 	// It means that the start condition has been correctly released 
 	// on the I2C bus (the bus is free, no other devices is communicating))
-	while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_MODE_SELECT));
+	if (i2c_wait_event(I2C_EVENT_MASTER_MODE_SELECT) != I2C_WAIT_OK)
+	{
+		return I2C_ERR_START;
+	}
+	
+	return I2C_OK;
 }
 
 /**
@@ -272,11 +450,14 @@ void i2c_stop()
   *	@brief	Write slave address to I2C bus
 	* @param	Slave address
 	* @param	I2C direction (transmitter or receiver)
-  * @retval	None
+  * @retval	Status code
   ******************************************************************************
   */
-void i2c_address_direction(uint8_t address, uint8_t direction)
+uint8_t i2c_address_direction(uint8_t address, uint8_t direction)
 {
+	uint32_t event;
+	uint8_t result;
+	
 	// Send slave address
 	I2C_Send7bitAddress(I2Cx, address, direction);
 	
@@ -284,67 +465,100 @@ void i2c_address_direction(uint8_t address, uint8_t direction)
 	// It means that a slave acknowledges his address
 	if (direction == I2C_Direction_Transmitter)
 	{
-		while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
+		event = I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED;
 	}
-	else if (direction == I2C_Direction_Receiver)
+	else
 	{	
-		while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED));
+		event = I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED;
+	}
+	result = i2c_wait_event(event);
+	if (result == I2C_WAIT_NACK)
+	{
+		return I2C_ERR_NACK;
 	}
+	if (result == I2C_WAIT_TIMEOUT)
+	{
+		return I2C_ERR_ADDR;
+	}
+	
+	return I2C_OK;
 }
 
 /**
   ******************************************************************************
   *	@brief	Transmit one byte to I2C bus
   * @param	Data byte to transmit
-  * @retval	None
+  * @retval	Status code
   ******************************************************************************
   */
-void i2c_transmit(uint8_t byte)
+uint8_t i2c_transmit(uint8_t byte)
 {
+	uint8_t result;
+	
 	// Send data byte
 	I2C_SendData(I2Cx, byte);
 	// Wait for I2C EV8_2.
 	// It means that the data has been physically shifted out and 
 	// output on the bus)
-	while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+	result = i2c_wait_event(I2C_EVENT_MASTER_BYTE_TRANSMITTED);
+	if (result == I2C_WAIT_NACK)
+	{
+		return I2C_ERR_TX_NACK;
+	}
+	if (result == I2C_WAIT_TIMEOUT)
+	{
+		return I2C_ERR_TX;
+	}
+	
+	return I2C_OK;
 }
 
 /**
   ******************************************************************************
   *	@brief	Receive data byte from I2C bus, then return ACK
-  * @param	None
-  * @retval	Received data byte
+  * @param	Pointer to store received data byte
+  * @retval	Status code
   ******************************************************************************
   */
-uint8_t i2c_receive_ack()
+uint8_t i2c_receive_ack(uint8_t* byte)
 {
 	// Enable ACK of received data
 	I2C_AcknowledgeConfig(I2Cx, ENABLE);
 	// Wait for I2C EV7
 	// It means that the data has been received in I2C data register
-	while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED));
+	if (i2c_wait_event(I2C_EVENT_MASTER_BYTE_RECEIVED) != I2C_WAIT_OK)
+	{
+		return I2C_ERR_RX;
+	}
+	
+	// Read data byte from I2C data register
+	*byte = I2C_ReceiveData(I2Cx);
 	
-	// Read and return data byte from I2C data register
-	return I2C_ReceiveData(I2Cx);
+	return I2C_OK;
 }
 
 /**
   ******************************************************************************
   *	@brief	Receive data byte from I2C bus, then return NACK
-  * @param	None
-  * @retval	Received data byte
+  * @param	Pointer to store received data byte
+  * @retval	Status code
   ******************************************************************************
   */
-uint8_t i2c_receive_nack()
+uint8_t i2c_receive_nack(uint8_t* byte)
 {
 	// Disable ACK of received data
 	I2C_AcknowledgeConfig(I2Cx, DISABLE);
 	// Wait for I2C EV7
 	// It means that the data has been received in I2C data register
-	while (!I2C_CheckEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED));
+	if (i2c_wait_event(I2C_EVENT_MASTER_BYTE_RECEIVED) != I2C_WAIT_OK)
+	{
+		return I2C_ERR_RX;
+	}
+	
+	// Read data byte from I2C data register
+	*byte = I2C_ReceiveData(I2Cx);
 	
-	// Read and return data byte from I2C data register
-	return I2C_ReceiveData(I2Cx);
+	return I2C_OK;
 }
 
 /********************************* END OF FILE ********************************/
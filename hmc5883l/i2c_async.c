@@ -0,0 +1,488 @@
+/**
+  ******************************************************************************
+  * @file		i2c_async.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "i2c_async.h"
+
+/** Private defines --------------------------------------------------------- */
+// Driver state, tells the event handler which event is expected next
+#define STATE_IDLE			0
+#define STATE_START			1		// Waiting for SB (EV5)
+#define STATE_ADDR			2		// Waiting for ADDR (EV6)
+#define STATE_TX				3		// Waiting for BTF after last tx byte (EV8_2)
+#define STATE_RX				4		// Waiting for DMA TC or RXNE (EV7)
+
+// Bounded wait for the hardware to release a STOP condition
+#define STOP_WAIT_LOOPS	1000
+
+/** Private variables ------------------------------------------------------- */
+// Transfer queue, head is the transfer currently on the bus
+static i2c_xfer_t* volatile head;
+static i2c_xfer_t* tail;
+static __IO uint8_t state;
+// Direction of the current address phase
+static uint8_t reading;
+
+/** Private function prototypes --------------------------------------------- */
+static void i2c_async_start(uint8_t restart);
+static void i2c_async_addr_write(i2c_xfer_t* xfer);
+static void i2c_async_addr_read(i2c_xfer_t* xfer);
+static void i2c_async_write_done(i2c_xfer_t* xfer);
+static void i2c_async_finish(uint8_t status, uint8_t restart);
+static void i2c_async_dma(DMA_Channel_TypeDef* channel, uint32_t ccr,
+	uint8_t* buf, uint16_t len);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize I2C master with event, error and DMA interrupts
+  * @param	Bus clock speed (I2C_SPEED_STANDARD or I2C_SPEED_FAST)
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_async_init(uint32_t speed)
+{
+	// Initialization struct
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+
+	// Step 1: Initialize I2C, fast mode duty cycle Tlow/Thigh = 2
+	RCC_APB1PeriphClockCmd(I2Cx_RCC, ENABLE);
+	i2c_async_set_speed(speed);
+
+	// Step 2: Initialize GPIO as open drain alternate function
+	RCC_APB2PeriphClockCmd(I2C_GPIO_RCC, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = I2C_PIN_SCL | I2C_PIN_SDA;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_OD;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(I2C_GPIO, &GPIO_InitStruct);
+
+	// Step 3: Fixed part of DMA setup, peripheral address is I2C data register
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	I2C_DMA_TX_CHANNEL->CCR = 0;
+	I2C_DMA_TX_CHANNEL->CPAR = (uint32_t) &I2Cx->DR;
+	I2C_DMA_RX_CHANNEL->CCR = 0;
+	I2C_DMA_RX_CHANNEL->CPAR = (uint32_t) &I2Cx->DR;
+
+	// Step 4: Initialize NVIC for I2C event, I2C error and DMA RX IRQ
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStruct.NVIC_IRQChannel = I2C_EV_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	NVIC_InitStruct.NVIC_IRQChannel = I2C_ER_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	NVIC_InitStruct.NVIC_IRQChannel = I2C_DMA_RX_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	head = 0;
+	tail = 0;
+	state = STATE_IDLE;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Queue a transfer. Can be called from main loop or interrupt
+  *					(including from a completion callback).
+  * @param	Pointer to transfer descriptor, must stay valid until done
+  * @retval	1 if queued, 0 if the descriptor is already queued
+  ******************************************************************************
+  */
+uint8_t i2c_async_submit(i2c_xfer_t* xfer)
+{
+	uint32_t primask;
+
+	if (xfer->status == I2C_XFER_QUEUED || xfer->status == I2C_XFER_BUSY)
+	{
+		return 0;
+	}
+	xfer->next = 0;
+	xfer->status = I2C_XFER_QUEUED;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (head)
+	{
+		tail->next = xfer;
+		tail = xfer;
+	}
+	else
+	{
+		head = xfer;
+		tail = xfer;
+		i2c_async_start(0);
+	}
+	if (!primask)
+	{
+		__enable_irq();
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether any transfer is queued or running
+  * @param	None
+  * @retval	1 if busy, otherwise 0
+  ******************************************************************************
+  */
+uint8_t i2c_async_busy()
+{
+	return head != 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Change bus clock speed, only call when no transfer is queued
+  * @param	Bus clock speed (I2C_SPEED_STANDARD or I2C_SPEED_FAST)
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_async_set_speed(uint32_t speed)
+{
+	I2C_InitTypeDef I2C_InitStruct;
+	uint16_t loops = STOP_WAIT_LOOPS;
+
+	// Clock control registers can only be written while disabled, let the
+	// STOP of the last transfer go out first
+	while ((I2Cx->CR1 & I2C_CR1_STOP) && --loops);
+	I2C_Cmd(I2Cx, DISABLE);
+	I2C_InitStruct.I2C_ClockSpeed = speed;
+	I2C_InitStruct.I2C_Mode = I2C_Mode_I2C;
+	I2C_InitStruct.I2C_DutyCycle = I2C_DutyCycle_2;
+	I2C_InitStruct.I2C_OwnAddress1 = 0x00;
+	I2C_InitStruct.I2C_Ack = I2C_Ack_Disable;
+	I2C_InitStruct.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+	I2C_Init(I2Cx, &I2C_InitStruct);
+	I2C_Cmd(I2Cx, ENABLE);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Abort the running transfer (e.g. slave holds the bus), it completes
+  *					with I2C_XFER_ERR_TIMEOUT and the next queued transfer starts
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_async_abort()
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (head)
+	{
+		I2Cx->CR1 |= I2C_CR1_STOP;
+		i2c_async_finish(I2C_XFER_ERR_TIMEOUT, 0);
+	}
+	if (!primask)
+	{
+		__enable_irq();
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	I2C event interrupt handler, runs the transfer state machine
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void I2C_EV_IRQHandler(void)
+{
+	i2c_xfer_t* xfer = head;
+	uint16_t sr1 = I2Cx->SR1;
+
+	if (!xfer)
+	{
+		I2Cx->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+		return;
+	}
+
+	if ((state == STATE_START) && (sr1 & I2C_SR1_SB))
+	{
+		// EV5: reading SR1 then writing DR clears SB
+		I2Cx->DR = (xfer->address << 1) | reading;
+		state = STATE_ADDR;
+	}
+	else if ((state == STATE_ADDR) && (sr1 & I2C_SR1_ADDR))
+	{
+		if (reading)
+		{
+			i2c_async_addr_read(xfer);
+		}
+		else
+		{
+			i2c_async_addr_write(xfer);
+		}
+	}
+	else if ((state == STATE_TX) && (sr1 & I2C_SR1_BTF))
+	{
+		i2c_async_write_done(xfer);
+	}
+	else if ((state == STATE_RX) && (xfer->rx_len == 1) && (sr1 & I2C_SR1_RXNE))
+	{
+		// Single byte read, STOP or START was already requested. Longer
+		// reads belong to DMA, a BTF event there must not touch DR.
+		xfer->rx[0] = I2Cx->DR;
+		i2c_async_finish(I2C_XFER_DONE, (xfer->flags & I2C_XFER_NO_STOP) && xfer->next);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	I2C error interrupt handler, aborts the current transfer
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void I2C_ER_IRQHandler(void)
+{
+	uint16_t sr1 = I2Cx->SR1;
+	uint8_t status = I2C_XFER_ERR_BUS;
+
+	// Error flags are cleared by writing 0
+	I2Cx->SR1 = (uint16_t) ~(I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR);
+
+	if (sr1 & I2C_SR1_AF)
+	{
+		status = I2C_XFER_ERR_NACK;
+	}
+	else if (sr1 & I2C_SR1_ARLO)
+	{
+		status = I2C_XFER_ERR_ARBITRATION;
+	}
+	else if (sr1 & I2C_SR1_OVR)
+	{
+		status = I2C_XFER_ERR_OVERRUN;
+	}
+
+	// After arbitration lost the interface is already back in slave mode
+	if (!(sr1 & I2C_SR1_ARLO))
+	{
+		I2Cx->CR1 |= I2C_CR1_STOP;
+	}
+
+	if (head)
+	{
+		i2c_async_finish(status, 0);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	DMA RX transfer complete handler, ends a multi-byte read
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void I2C_DMA_RX_IRQHandler(void)
+{
+	if (DMA1->ISR & I2C_DMA_RX_TC_FLAG)
+	{
+		i2c_xfer_t* xfer = head;
+		uint8_t restart = xfer && (xfer->flags & I2C_XFER_NO_STOP) && xfer->next;
+
+		DMA1->IFCR = I2C_DMA_RX_CLEAR;
+		// Last byte was NACKed by hardware (LAST bit), end with STOP or
+		// repeated START for the chained transfer
+		I2Cx->CR1 |= restart ? I2C_CR1_START : I2C_CR1_STOP;
+		if (xfer && (state == STATE_RX))
+		{
+			i2c_async_finish(I2C_XFER_DONE, restart);
+		}
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Generate START for the transfer at the queue head
+  * @param	1 if START has already been requested (repeated start)
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_start(uint8_t restart)
+{
+	i2c_xfer_t* xfer = head;
+	uint16_t loops = STOP_WAIT_LOOPS;
+
+	// Write phase is skipped for a pure read
+	reading = !(xfer->flags & I2C_XFER_REG) && (xfer->tx_len == 0) &&
+		(xfer->rx_len > 0);
+	xfer->status = I2C_XFER_BUSY;
+	state = STATE_START;
+
+	if (!restart)
+	{
+		// A STOP from the previous transfer may still be on its way out
+		while ((I2Cx->CR1 & I2C_CR1_STOP) && --loops);
+		I2Cx->CR1 |= I2C_CR1_START;
+	}
+	I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Address acknowledged in transmitter mode (EV6), start sending
+  * @param	Current transfer
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_addr_write(i2c_xfer_t* xfer)
+{
+	// Reading SR2 after SR1 clears ADDR
+	(void) I2Cx->SR2;
+
+	if (xfer->flags & I2C_XFER_REG)
+	{
+		I2Cx->DR = xfer->reg;
+	}
+	if (xfer->tx_len)
+	{
+		// DMA feeds the rest on every TXE
+		i2c_async_dma(I2C_DMA_TX_CHANNEL, DMA_CCR1_MINC | DMA_CCR1_DIR,
+			(uint8_t*) xfer->tx, xfer->tx_len);
+		I2Cx->CR2 |= I2C_CR2_DMAEN;
+	}
+
+	if ((xfer->flags & I2C_XFER_REG) || xfer->tx_len)
+	{
+		state = STATE_TX;
+	}
+	else
+	{
+		// Nothing to send (address probe)
+		i2c_async_write_done(xfer);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Address acknowledged in receiver mode (EV6), start receiving
+  * @param	Current transfer
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_addr_read(i2c_xfer_t* xfer)
+{
+	state = STATE_RX;
+
+	if (xfer->rx_len == 1)
+	{
+		// Single byte: NACK and STOP (or START) must be set right after
+		// ADDR is cleared, the byte then arrives on RXNE
+		I2Cx->CR1 &= ~I2C_CR1_ACK;
+		(void) I2Cx->SR2;
+		I2Cx->CR1 |= ((xfer->flags & I2C_XFER_NO_STOP) && xfer->next) ?
+			I2C_CR1_START : I2C_CR1_STOP;
+		I2Cx->CR2 |= I2C_CR2_ITBUFEN;
+	}
+	else
+	{
+		// LAST makes hardware NACK the final byte of the DMA transfer
+		I2Cx->CR1 |= I2C_CR1_ACK;
+		i2c_async_dma(I2C_DMA_RX_CHANNEL, DMA_CCR1_MINC | DMA_CCR1_TCIE,
+			xfer->rx, xfer->rx_len);
+		I2Cx->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
+		(void) I2Cx->SR2;
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Write phase finished (EV8_2), continue with read or end transfer
+  * @param	Current transfer
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_write_done(i2c_xfer_t* xfer)
+{
+	I2Cx->CR2 &= ~I2C_CR2_DMAEN;
+	I2C_DMA_TX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+	DMA1->IFCR = I2C_DMA_TX_CLEAR;
+
+	if (xfer->rx_len)
+	{
+		// Repeated START then address + R
+		reading = 1;
+		state = STATE_START;
+		I2Cx->CR1 |= I2C_CR1_START;
+	}
+	else if ((xfer->flags & I2C_XFER_NO_STOP) && xfer->next)
+	{
+		I2Cx->CR1 |= I2C_CR1_START;
+		i2c_async_finish(I2C_XFER_DONE, 1);
+	}
+	else
+	{
+		I2Cx->CR1 |= I2C_CR1_STOP;
+		i2c_async_finish(I2C_XFER_DONE, 0);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Complete the head transfer and start the next one
+  * @param	Transfer status
+  * @param	1 if a repeated START was already requested for the next one
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_finish(uint8_t status, uint8_t restart)
+{
+	i2c_xfer_t* xfer = head;
+
+	I2Cx->CR2 &= ~(I2C_CR2_ITBUFEN | I2C_CR2_DMAEN | I2C_CR2_LAST);
+	I2C_DMA_TX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+	I2C_DMA_RX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+	DMA1->IFCR = I2C_DMA_TX_CLEAR | I2C_DMA_RX_CLEAR;
+
+	// Pop before the callback, it may queue new transfers
+	head = xfer->next;
+	xfer->next = 0;
+	if (head)
+	{
+		i2c_async_start(restart);
+	}
+	else
+	{
+		tail = 0;
+		state = STATE_IDLE;
+		I2Cx->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN);
+	}
+
+	xfer->status = status;
+	if (xfer->callback)
+	{
+		xfer->callback(xfer);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Program and enable a DMA channel for the I2C data register
+  * @param	DMA channel
+  * @param	CCR direction and interrupt bits
+  * @param	Memory buffer
+  * @param	Number of bytes
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_async_dma(DMA_Channel_TypeDef* channel, uint32_t ccr,
+	uint8_t* buf, uint16_t len)
+{
+	channel->CCR = 0;
+	channel->CMAR = (uint32_t) buf;
+	channel->CNDTR = len;
+	channel->CCR = ccr | DMA_CCR1_PL_1 | DMA_CCR1_EN;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file		i2c_async.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Interrupt and DMA driven I2C master. Transfers are queued as
+	*					descriptors and run one after another without CPU polling.
+	*					Uses the same I2C peripheral and pins as i2c.h, do not call
+	*					the blocking i2c_xxx() functions while transfers are queued.
+  ******************************************************************************
+  */
+
+#ifndef __I2C_ASYNC_H
+#define __I2C_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_i2c.h"
+#include "misc.h"
+#include "i2c.h"
+
+/** Defines ----------------------------------------------------------------- */
+// DMA channels and IRQs for I2C2 (use channel 6/7 and I2C1 IRQs for I2C1)
+#define I2C_DMA_TX_CHANNEL				DMA1_Channel4
+#define I2C_DMA_RX_CHANNEL				DMA1_Channel5
+#define I2C_DMA_RX_TC_FLAG				DMA_ISR_TCIF5
+#define I2C_DMA_RX_CLEAR					DMA_IFCR_CGIF5
+#define I2C_DMA_TX_CLEAR					DMA_IFCR_CGIF4
+#define I2C_EV_IRQn								I2C2_EV_IRQn
+#define I2C_ER_IRQn								I2C2_ER_IRQn
+#define I2C_DMA_RX_IRQn						DMA1_Channel5_IRQn
+#define I2C_EV_IRQHandler					I2C2_EV_IRQHandler
+#define I2C_ER_IRQHandler					I2C2_ER_IRQHandler
+#define I2C_DMA_RX_IRQHandler			DMA1_Channel5_IRQHandler
+
+// Bus clock speed
+#define I2C_SPEED_STANDARD				100000
+#define I2C_SPEED_FAST						400000
+
+// Transfer flags
+#define I2C_XFER_REG							0x01	// Send reg byte before tx data
+#define I2C_XFER_NO_STOP					0x02	// Chain next transfer with repeated start
+
+// Transfer status
+#define I2C_XFER_IDLE							0
+#define I2C_XFER_QUEUED						1
+#define I2C_XFER_BUSY							2
+#define I2C_XFER_DONE							3
+#define I2C_XFER_ERR_NACK					4
+#define I2C_XFER_ERR_BUS					5
+#define I2C_XFER_ERR_ARBITRATION	6
+#define I2C_XFER_ERR_OVERRUN			7
+#define I2C_XFER_ERR_TIMEOUT			8
+
+/** Typedefs ---------------------------------------------------------------- */
+struct i2c_xfer;
+typedef void (*i2c_xfer_callback_t)(struct i2c_xfer* xfer);
+
+// Transfer descriptor: START, address + W, [reg], [tx], then if rx_len > 0
+// repeated START, address + R, rx, and finally STOP (unless chained)
+typedef struct i2c_xfer
+{
+	uint8_t address;							// 7-bit slave address
+	uint8_t flags;
+	uint8_t reg;
+	const uint8_t* tx;
+	uint16_t tx_len;
+	uint8_t* rx;
+	uint16_t rx_len;
+	i2c_xfer_callback_t callback;	// Called from interrupt when done, may be 0
+	void* arg;
+	__IO uint8_t status;
+	struct i2c_xfer* next;				// Queue link, owned by the driver
+} i2c_xfer_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void i2c_async_init(uint32_t speed);
+uint8_t i2c_async_submit(i2c_xfer_t* xfer);
+uint8_t i2c_async_busy(void);
+void i2c_async_set_speed(uint32_t speed);
+void i2c_async_abort(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,366 @@
+/**
+  ******************************************************************************
+  * @file		i2c_bus.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "i2c_bus.h"
+
+/** Private variables ------------------------------------------------------- */
+// Waiting requests, one FIFO per priority
+static i2c_request_t* queueHead[I2C_BUS_PRIORITIES];
+static i2c_request_t* queueTail[I2C_BUS_PRIORITIES];
+// Request on the bus
+static i2c_request_t* volatile current;
+static uint32_t currentStart;
+static uint32_t currentStartMs;
+static uint32_t currentSpeed;
+// Set while the bus is being recovered, no request is started
+static __IO uint8_t recovering;
+static i2c_poll_t* polls;
+
+// Statistics of the current report window
+static uint32_t cyclesPerUs;
+static uint64_t windowStart;
+static uint64_t busyCycles;
+static uint32_t transfers;
+static uint32_t errors;
+static uint32_t timeouts;
+static uint32_t maxLatency[I2C_BUS_PRIORITIES];
+
+/** Private function prototypes --------------------------------------------- */
+static void i2c_bus_start_next(void);
+static void i2c_bus_done(i2c_xfer_t* xfer);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize I2C (interrupt driven) and the bus manager.
+  *					DelayInit() must be called first.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_bus_init()
+{
+	i2c_async_init(I2C_SPEED_STANDARD);
+	currentSpeed = I2C_SPEED_STANDARD;
+	cyclesPerUs = SystemCoreClock / 1000000;
+	windowStart = DelayGetCycles64();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Queue a request for its device. Can be called from main loop or
+  *					interrupt (including from a request callback).
+  * @param	Pointer to request, must stay valid until done
+  * @retval	1 if queued, 0 if the request is already queued or running
+  ******************************************************************************
+  */
+uint8_t i2c_bus_submit(i2c_request_t* request)
+{
+	uint8_t priority = request->device->priority;
+	uint32_t primask;
+
+	if ((request->xfer.status == I2C_XFER_QUEUED) || 
+		(request->xfer.status == I2C_XFER_BUSY))
+	{
+		return 0;
+	}
+	if (priority >= I2C_BUS_PRIORITIES)
+	{
+		priority = I2C_BUS_PRIORITIES - 1;
+	}
+
+	request->xfer.address = request->device->address;
+	request->xfer.callback = i2c_bus_done;
+	request->xfer.status = I2C_XFER_QUEUED;
+	request->queued = DelayGetCycles();
+	request->next = 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (queueTail[priority])
+	{
+		queueTail[priority]->next = request;
+	}
+	else
+	{
+		queueHead[priority] = request;
+	}
+	queueTail[priority] = request;
+	if (!current && !recovering)
+	{
+		i2c_bus_start_next();
+	}
+	if (!primask)
+	{
+		__enable_irq();
+	}
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Add a request that is submitted every period, starting now
+  * @param	Pointer to poll, its request must be filled in
+  * @param	Period in ms
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_bus_poll_add(i2c_poll_t* poll, uint32_t period_ms)
+{
+	poll->period_ms = period_ms;
+	poll->next_ms = DelayGetMs();
+	poll->next = polls;
+	polls = poll;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Submit due polls, abort a transfer that exceeds the timeout of
+  *					its device and recover the bus. Call this from the main loop.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_bus_process()
+{
+	uint32_t now = DelayGetMs();
+	i2c_request_t* request;
+	i2c_poll_t* poll;
+
+	// Timeout 0 means no timeout
+	__disable_irq();
+	request = current;
+	if (request && request->device->timeout_ms && 
+		((now - currentStartMs) > request->device->timeout_ms))
+	{
+		recovering = 1;
+		i2c_async_abort();
+	}
+	__enable_irq();
+
+	if (recovering)
+	{
+		// Release a slave that holds SDA, this leaves the clock at default
+		i2c_bus_recovery();
+		currentSpeed = I2C_SPEED;
+		__disable_irq();
+		recovering = 0;
+		if (!current)
+		{
+			i2c_bus_start_next();
+		}
+		__enable_irq();
+	}
+
+	for (poll = polls; poll; poll = poll->next)
+	{
+		if ((int32_t)(now - poll->next_ms) >= 0)
+		{
+			// Still queued from the last period counts as a skipped poll
+			i2c_bus_submit(&poll->request);
+			poll->next_ms += poll->period_ms;
+			if ((int32_t)(now - poll->next_ms) >= 0)
+			{
+				// Fell behind, do not burst to catch up
+				poll->next_ms = now + poll->period_ms;
+			}
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get how long the main loop may sleep before i2c_bus_process()
+  *					has work to do (a poll is due or a transfer times out)
+  * @param	None
+  * @retval	Time in ms (0 = process now, I2C_BUS_NO_TIMEOUT = nothing due)
+  ******************************************************************************
+  */
+uint32_t i2c_bus_idle_ms()
+{
+	uint32_t now = DelayGetMs();
+	uint32_t best = I2C_BUS_NO_TIMEOUT;
+	uint32_t wait;
+	i2c_request_t* request;
+	i2c_poll_t* poll;
+
+	if (recovering)
+	{
+		return 0;
+	}
+
+	for (poll = polls; poll; poll = poll->next)
+	{
+		if ((int32_t)(now - poll->next_ms) >= 0)
+		{
+			return 0;
+		}
+		wait = poll->next_ms - now;
+		if (wait < best)
+		{
+			best = wait;
+		}
+	}
+
+	// The timeout is exceeded one tick after timeout_ms
+	__disable_irq();
+	request = current;
+	if (request && request->device->timeout_ms)
+	{
+		wait = now - currentStartMs;
+		wait = (wait > request->device->timeout_ms) ? 0 : 
+			(request->device->timeout_ms + 1 - wait);
+		if (wait < best)
+		{
+			best = wait;
+		}
+	}
+	__enable_irq();
+
+	return best;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get bus statistics since the last report and start a new window
+  * @param	Pointer to store the report
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_bus_report(i2c_bus_report_t* report)
+{
+	uint64_t now;
+	uint64_t window;
+	uint8_t i;
+
+	__disable_irq();
+	now = DelayGetCycles64();
+	window = now - windowStart;
+	report->utilization = window ? (uint16_t)((busyCycles * 1000) / window) : 0;
+	report->window_ms = (uint32_t)(window / (cyclesPerUs * 1000));
+	report->transfers = transfers;
+	report->errors = errors;
+	report->timeouts = timeouts;
+	for (i = 0; i < I2C_BUS_PRIORITIES; i++)
+	{
+		report->max_latency_us[i] = maxLatency[i] / cyclesPerUs;
+		maxLatency[i] = 0;
+	}
+	windowStart = now;
+	busyCycles = 0;
+	transfers = 0;
+	errors = 0;
+	timeouts = 0;
+	__enable_irq();
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Put the oldest request of the highest priority on the bus.
+  *					Called with interrupts disabled or from interrupt.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_bus_start_next()
+{
+	i2c_request_t* request = 0;
+	uint8_t i;
+
+	for (i = 0; i < I2C_BUS_PRIORITIES; i++)
+	{
+		request = queueHead[i];
+		if (request)
+		{
+			queueHead[i] = request->next;
+			if (!queueHead[i])
+			{
+				queueTail[i] = 0;
+			}
+			break;
+		}
+	}
+	current = request;
+	if (!request)
+	{
+		return;
+	}
+
+	if (request->device->speed != currentSpeed)
+	{
+		i2c_async_set_speed(request->device->speed);
+		currentSpeed = request->device->speed;
+	}
+	currentStart = DelayGetCycles();
+	currentStartMs = DelayGetMs();
+
+	// Hand over from the bus queue to the driver queue
+	request->xfer.status = I2C_XFER_IDLE;
+	i2c_async_submit(&request->xfer);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Transfer finished (interrupt context), update statistics, start
+  *					the next request then call the request callback
+  * @param	Finished transfer
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_bus_done(i2c_xfer_t* xfer)
+{
+	i2c_request_t* request = (i2c_request_t*)xfer;
+	i2c_device_t* device = request->device;
+	uint32_t now = DelayGetCycles();
+	uint32_t latency = now - request->queued;
+	uint8_t priority = device->priority;
+
+	if (priority >= I2C_BUS_PRIORITIES)
+	{
+		priority = I2C_BUS_PRIORITIES - 1;
+	}
+
+	busyCycles += now - currentStart;
+	transfers++;
+	device->transfers++;
+	if (xfer->status == I2C_XFER_ERR_TIMEOUT)
+	{
+		timeouts++;
+		device->timeouts++;
+	}
+	else if (xfer->status != I2C_XFER_DONE)
+	{
+		errors++;
+		device->errors++;
+	}
+	if (latency > maxLatency[priority])
+	{
+		maxLatency[priority] = latency;
+	}
+	if ((latency / cyclesPerUs) > device->max_latency_us)
+	{
+		device->max_latency_us = latency / cyclesPerUs;
+	}
+
+	current = 0;
+	if (!recovering)
+	{
+		i2c_bus_start_next();
+	}
+
+	if (request->callback)
+	{
+		request->callback(xfer);
+	}
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file		i2c_bus.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Shares one I2C bus between several devices on top of i2c_async.
+	*					Each device has its own address, clock speed, timeout and
+	*					priority. Requests wait in one queue per priority and are put
+	*					on the bus one at a time, so a request waits at most for the
+	*					transfer already on the bus plus the queued requests of equal
+	*					or higher priority. Periodic polls are issued from
+	*					i2c_bus_process() in the main loop.
+  ******************************************************************************
+  */
+
+#ifndef __I2C_BUS_H
+#define __I2C_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "delay.h"
+#include "i2c.h"
+#include "i2c_async.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Request priority, lower value is served first
+#define I2C_BUS_PRIO_HIGH					0
+#define I2C_BUS_PRIO_NORMAL				1
+#define I2C_BUS_PRIO_LOW					2
+#define I2C_BUS_PRIORITIES				3
+
+// Returned by i2c_bus_idle_ms() when nothing is due
+#define I2C_BUS_NO_TIMEOUT				0xFFFFFFFF
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint8_t address;							// 7-bit slave address
+	uint8_t priority;							// I2C_BUS_PRIO_xxx
+	uint32_t speed;								// Bus clock speed for this device
+	uint16_t timeout_ms;					// Max time on the bus per transfer
+	// Statistics, updated by the bus manager
+	uint32_t transfers;
+	uint32_t errors;
+	uint32_t timeouts;
+	uint32_t max_latency_us;			// From submit to completion
+} i2c_device_t;
+
+// Request: the transfer fields are set by the user, the address is taken
+// from the device. The callback runs in interrupt context when done.
+typedef struct i2c_request
+{
+	i2c_xfer_t xfer;							// Must be first
+	i2c_device_t* device;
+	i2c_xfer_callback_t callback;	// May be 0
+	uint32_t queued;							// Cycle counter at submit, internal
+	struct i2c_request* next;			// Queue link, internal
+} i2c_request_t;
+
+// Request repeated by i2c_bus_process() every period_ms
+typedef struct i2c_poll
+{
+	i2c_request_t request;
+	uint32_t period_ms;
+	uint32_t next_ms;							// Internal
+	struct i2c_poll* next;				// Internal
+} i2c_poll_t;
+
+typedef struct
+{
+	uint16_t utilization;					// Bus busy time in permille of the window
+	uint32_t window_ms;
+	uint32_t transfers;
+	uint32_t errors;
+	uint32_t timeouts;
+	uint32_t max_latency_us[I2C_BUS_PRIORITIES];
+} i2c_bus_report_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void i2c_bus_init(void);
+uint8_t i2c_bus_submit(i2c_request_t* request);
+void i2c_bus_poll_add(i2c_poll_t* poll, uint32_t period_ms);
+void i2c_bus_process(void);
+uint32_t i2c_bus_idle_ms(void);
+void i2c_bus_report(i2c_bus_report_t* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
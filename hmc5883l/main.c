@@ -4,74 +4,195 @@
 #include "stm32f10x_i2c.h"
 #include "delay.h"
 #include "lcd16x2.h"
-#include "i2c.h"
-#include <stdio.h>
+#include "i2c_bus.h"
+#include "hmc5883l.h"
+#include "compass.h"
+#include "fmt.h"
+#include "swtimer.h"
 
-#define HMC5833L_DEVICE_ADDRESS				0x1E
-#define HMC5833L_CFG_A_REGISTER				0x00
-#define HMC5833L_CFG_B_REGISTER				0x01
-#define HMC5833L_MODE_REGISTER				0x02
-#define HMC5833L_DO_REGISTER_START		0x03
+// Local magnetic declination in tenths of degrees (east positive)
+#define DECLINATION_DEG10		7
+// Time to turn the sensor around when no calibration is stored
+#define CALIBRATION_MS			20000
+
+// Other devices sharing the bus: DS1307 RTC and the i2c-slave-interrupt
+// example (control register bit 0 turns its LED blinking on)
+#define DS1307_ADDRESS			0x68
+#define SLAVE_ADDRESS				0x08
+#define SLAVE_REG_CONTROL		0x01
 
 void HMC5883_Init(void);
-void HMC5883_GetHeadings(void);
+void Bus_Init(void);
+void compass_update(void* arg);
+void calibration_done(void* arg);
+void bus_report_update(void* arg);
+void slave_command_done(i2c_xfer_t* xfer);
 
 int16_t rawX, rawY, rawZ;
+uint16_t heading;
 char buf[8];
+swtimer_t compass_timer;
+swtimer_t calibration_timer;
+swtimer_t report_timer;
+// Shared bus: RTC time read at 1 Hz, LED command to the slave at 2 Hz
+i2c_device_t rtc = { DS1307_ADDRESS, I2C_BUS_PRIO_NORMAL, I2C_SPEED_STANDARD, 5 };
+i2c_device_t slave = { SLAVE_ADDRESS, I2C_BUS_PRIO_LOW, I2C_SPEED_STANDARD, 5 };
+i2c_poll_t rtc_poll;
+i2c_poll_t slave_poll;
+uint8_t rtc_time[7];
+uint8_t slave_command;
+i2c_bus_report_t bus_report;
+hmc5883l_sample_t sample;
+uint8_t calibrating;
 
 int main(void)
 {
+	uint32_t idle, busIdle;
+	
 	DelayInit();
 	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
 	
-	// Initialize HMC5883L
+	// Initialize shared I2C bus, then HMC5883L on it
+	Bus_Init();
 	HMC5883_Init();
 	
+	// Display latest headings every 250 ms
+	swtimer_init();
+	swtimer_create(&compass_timer, compass_update, 0);
+	swtimer_start(&compass_timer, 0, 250);
+	// Bus utilization and latency, for the debugger watch window
+	swtimer_create(&report_timer, bus_report_update, 0);
+	swtimer_start(&report_timer, 1000, 1000);
+	
+	// Use stored hard/soft iron calibration, or collect a new one while
+	// the sensor is turned around
+	compass_set_declination(DECLINATION_DEG10);
+	if (!compass_cal_load())
+	{
+		calibrating = 1;
+		compass_cal_start();
+		swtimer_create(&calibration_timer, calibration_done, 0);
+		swtimer_start(&calibration_timer, CALIBRATION_MS, 0);
+	}
+	
 	while (1)
 	{
-		HMC5883_GetHeadings();
+		// Samples arrive on DRDY at the sensor output rate, heading is
+		// computed for every sample and the latest one is displayed
+		while (hmc5883l_read(&sample))
+		{
+			rawX = sample.x;
+			rawY = sample.y;
+			rawZ = sample.z;
+			if (calibrating)
+			{
+				compass_cal_update(rawX, rawY, rawZ);
+			}
+			heading = compass_heading(rawX, rawY, rawZ);
+		}
 		
-		lcd16x2_clrscr();
-		lcd16x2_puts("X,Y,Z =\n");
-		sprintf(buf, "%d,", rawX);
-		lcd16x2_puts(buf);
-		sprintf(buf, "%d,", rawY);
-		lcd16x2_puts(buf);
-		sprintf(buf, "%d", rawZ);
-		lcd16x2_puts(buf);
-		
-		DelayMs(250);
+		i2c_bus_process();
+		swtimer_process();
+		// Sleep until the next timer, poll or transfer timeout is due, or
+		// an interrupt occurs
+		idle = swtimer_idle_ms();
+		busIdle = i2c_bus_idle_ms();
+		DelayIdle((busIdle < idle) ? busIdle : idle);
 	}
 }
 
-void HMC5883_Init()
+void compass_update(void* arg)
 {
-	// Initialize I2C
-	i2c_init();
+	uint8_t len;
+	uint16_t deg10;
 	
-	// Set HMC5883L to default configuration (from datasheet) 
-	i2c_write_with_reg(HMC5833L_DEVICE_ADDRESS, HMC5833L_CFG_A_REGISTER, 0x70);
-	i2c_write_with_reg(HMC5833L_DEVICE_ADDRESS, HMC5833L_CFG_B_REGISTER, 0xA0);
-	// Set HMC5883L to continuous measurement mode
-	i2c_write_with_reg(HMC5833L_DEVICE_ADDRESS, HMC5833L_MODE_REGISTER, 0x00);
+	lcd16x2_clrscr();
+	if (calibrating)
+	{
+		lcd16x2_puts("Turn around...\n");
+	}
+	else
+	{
+		// Heading in degrees with one decimal
+		lcd16x2_puts("Heading ");
+		deg10 = COMPASS_Q15_TO_DEG10(heading);
+		len = fmt_dec(buf, deg10 / 10, 3, FMT_PAD_SPACE);
+		buf[len++] = '.';
+		buf[len++] = '0' + (deg10 % 10);
+		buf[len] = '\0';
+		lcd16x2_puts(buf);
+		lcd16x2_puts("\n");
+	}
+	len = fmt_int(buf, rawX, 0, FMT_PAD_SPACE);
+	buf[len++] = ',';
+	buf[len] = '\0';
+	lcd16x2_puts(buf);
+	len = fmt_int(buf, rawY, 0, FMT_PAD_SPACE);
+	buf[len++] = ',';
+	buf[len] = '\0';
+	lcd16x2_puts(buf);
+	buf[fmt_int(buf, rawZ, 0, FMT_PAD_SPACE)] = '\0';
+	lcd16x2_puts(buf);
 }
 
-void HMC5883_GetHeadings()
+void Bus_Init()
 {
-	// Raw value from data output register 
-	// (X MSB, X LSB, Z MSB, Z LSB, Y MSB, Y LSB)
-	uint8_t rawValue[6];
-	i2c_read_multi_with_reg(HMC5833L_DEVICE_ADDRESS, 0x03, 6, rawValue);
+	i2c_bus_init();
 	
-	// Store MSB and LSB of raw X value
-	rawX = rawValue[0] << 8;
-	rawX |= rawValue[1];
+	// Read DS1307 time registers every second
+	rtc_poll.request.device = &rtc;
+	rtc_poll.request.xfer.flags = I2C_XFER_REG;
+	rtc_poll.request.xfer.reg = 0x00;
+	rtc_poll.request.xfer.rx = rtc_time;
+	rtc_poll.request.xfer.rx_len = sizeof(rtc_time);
+	i2c_bus_poll_add(&rtc_poll, 1000);
 	
-	// Store MSB and LSB of raw Z value
-	rawZ = rawValue[2] << 8;
-	rawZ |= rawValue[3];
+	// Send LED command to the slave MCU every 500 ms
+	slave_poll.request.device = &slave;
+	slave_poll.request.xfer.flags = I2C_XFER_REG;
+	slave_poll.request.xfer.reg = SLAVE_REG_CONTROL;
+	slave_poll.request.xfer.tx = &slave_command;
+	slave_poll.request.xfer.tx_len = 1;
+	slave_poll.request.callback = slave_command_done;
+	i2c_bus_poll_add(&slave_poll, 500);
+}
+
+void HMC5883_Init()
+{
+	hmc5883l_config_t config;
 	
-	// Store MSB and LSB of raw Y	value
-	rawY = rawValue[4] << 8;
-	rawY |= rawValue[5];
+	// 75 Hz continuous output, average of 1 sample, gain 1.3 Ga
+	// (default gain from datasheet)
+	config.rate = HMC5883L_RATE_75HZ;
+	config.average = HMC5883L_AVERAGE_1;
+	config.gain = HMC5883L_GAIN_1_3GA;
+	config.mode = HMC5883L_CONTINUOUS;
+	hmc5883l_init(&config);
+}
+
+void calibration_done(void* arg)
+{
+	// Keep the calibration in backup registers, otherwise try again
+	if (compass_cal_finish())
+	{
+		compass_cal_save();
+		calibrating = 0;
+	}
+	else
+	{
+		compass_cal_start();
+		swtimer_start(&calibration_timer, CALIBRATION_MS, 0);
+	}
+}
+
+void bus_report_update(void* arg)
+{
+	i2c_bus_report(&bus_report);
+}
+
+// Called from interrupt when the slave command was sent
+void slave_command_done(i2c_xfer_t* xfer)
+{
+	// Toggle LED command for the next poll
+	slave_command ^= 0x01;
 }
@@ -13,6 +13,8 @@
 #define I2C_PIN_SCL			GPIO_Pin_10
 
 #define SLAVE_ADDRESS		0x08
+// Register of the i2c-slave-interrupt example, bit 0 = LED blinking on
+#define REG_CONTROL			0x01
 
 void i2c_init(void);
 void i2c_start(void);
@@ -21,8 +23,8 @@ void i2c_address_direction(uint8_t address, uint8_t direction);
 void i2c_transmit(uint8_t byte);
 uint8_t i2c_receive_ack(void);
 uint8_t i2c_receive_nack(void);
-void i2c_write(uint8_t address, uint8_t data);
-void i2c_read(uint8_t address, uint8_t* data);
+void i2c_write(uint8_t address, uint8_t reg, uint8_t data);
+void i2c_read(uint8_t address, uint8_t reg, uint8_t* data);
 
 uint8_t receivedByte;
 	
@@ -36,11 +38,11 @@ int main(void)
 	
 	while (1)
 	{
-		// Write 0x01 to slave (turn on LED blinking)
-		i2c_write(SLAVE_ADDRESS, 0x01);
+		// Write 0x01 to slave control register (turn on LED blinking)
+		i2c_write(SLAVE_ADDRESS, REG_CONTROL, 0x01);
 		DelayMs(5);
 		// Read LED blinking status (off/on)
-		i2c_read(SLAVE_ADDRESS, &receivedByte);
+		i2c_read(SLAVE_ADDRESS, REG_CONTROL, &receivedByte);
 		// Display LED blinking status
 		lcd16x2_clrscr();
 		if (receivedByte == 0)
@@ -53,11 +55,11 @@ int main(void)
 		}
 		DelayMs(2500);
 		
-		// Write 0x00 to slave (turn off LED blinking)
-		i2c_write(SLAVE_ADDRESS, 0x00);
+		// Write 0x00 to slave control register (turn off LED blinking)
+		i2c_write(SLAVE_ADDRESS, REG_CONTROL, 0x00);
 		DelayMs(5);
 		// Read LED blinking status (off/on)
-		i2c_read(SLAVE_ADDRESS, &receivedByte);
+		i2c_read(SLAVE_ADDRESS, REG_CONTROL, &receivedByte);
 		// Display LED blinking status
 		lcd16x2_clrscr();
 		if (receivedByte == 0)
@@ -170,16 +172,24 @@ uint8_t i2c_receive_nack()
 	return I2C_ReceiveData(I2Cx);
 }
 
-void i2c_write(uint8_t address, uint8_t data)
+void i2c_write(uint8_t address, uint8_t reg, uint8_t data)
 {
+	// First byte sets the slave register pointer, data goes to that register
 	i2c_start();
 	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
+	i2c_transmit(reg);
 	i2c_transmit(data);
 	i2c_stop();
 }
 
-void i2c_read(uint8_t address, uint8_t* data)
+void i2c_read(uint8_t address, uint8_t reg, uint8_t* data)
 {
+	// Set the slave register pointer, then read from it
+	i2c_start();
+	i2c_address_direction(address << 1, I2C_Direction_Transmitter);
+	i2c_transmit(reg);
+	i2c_stop();
+	
 	i2c_start();
 	i2c_address_direction(address << 1, I2C_Direction_Receiver);
 	*data = i2c_receive_nack();
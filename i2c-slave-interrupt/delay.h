@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file		delay.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		10 January 2016
+  ******************************************************************************
+  */
+	
+#ifndef __DELAY_H
+#define __DELAY_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include "stm32f10x.h"
+
+// Pass to DelayIdle() to sleep as long as SysTick can be suppressed
+#define DELAY_IDLE_FOREVER	0xFFFFFFFF
+
+void DelayInit(void);
+void DelayUs(uint32_t us);
+void DelayMs(uint32_t ms);
+uint32_t DelayGetCycles(void);
+uint64_t DelayGetCycles64(void);
+uint64_t DelayGetUs(void);
+uint32_t DelayGetMs(void);
+void DelayIdle(uint32_t ms);
+void DelayIdleUntil(uint8_t (*ready)(void), uint32_t ms);
+void DelaySleepMs(uint32_t ms);
+uint16_t DelayGetSleepPermille(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,278 @@
+/**
+  ******************************************************************************
+  * @file		i2c_slave.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "i2c_slave.h"
+#include <string.h>
+
+/** Private variables ------------------------------------------------------- */
+static uint8_t regs[I2C_SLAVE_REGS];
+// Copy of the map taken at the start of every master read, so multi-byte
+// values read in one transaction are consistent
+static uint8_t snapshot[I2C_SLAVE_REGS];
+// Access flags of every register, 0 = not mapped
+static uint8_t access[I2C_SLAVE_REGS];
+static const i2c_slave_region_t* regionTable;
+static uint8_t regionCount;
+// Register pointer, auto-incremented after every byte
+static uint8_t pointer;
+// Next received byte is the register pointer
+static uint8_t pointerByte;
+// Registers changed by the current write transaction
+static uint8_t dirty;
+static uint8_t dirtyFirst;
+static uint8_t dirtyLast;
+
+/** Private function prototypes --------------------------------------------- */
+static void i2c_slave_notify(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize I2C in slave mode with a register map
+  * @param	Own slave address (7-bit right aligned)
+  * @param	Region table, must stay valid
+  * @param	Number of regions
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_slave_init(uint8_t address, const i2c_slave_region_t* regions, 
+	uint8_t count)
+{
+	// Initialization struct
+	I2C_InitTypeDef I2C_InitStruct;
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	uint8_t i, reg;
+
+	// Access flags from the regions
+	regionTable = regions;
+	regionCount = count;
+	for (i = 0; i < count; i++)
+	{
+		for (reg = regions[i].first; 
+			(reg < (regions[i].first + regions[i].count)) && (reg < I2C_SLAVE_REGS); 
+			reg++)
+		{
+			access[reg] = regions[i].access;
+		}
+	}
+
+	// Step 1: Initialize I2C, slave must acknowledge its address
+	RCC_APB1PeriphClockCmd(I2Cx_RCC, ENABLE);
+	I2C_InitStruct.I2C_ClockSpeed = 100000;
+	I2C_InitStruct.I2C_Mode = I2C_Mode_I2C;
+	I2C_InitStruct.I2C_DutyCycle = I2C_DutyCycle_2;
+	I2C_InitStruct.I2C_OwnAddress1 = address << 1;
+	I2C_InitStruct.I2C_Ack = I2C_Ack_Enable;
+	I2C_InitStruct.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+	I2C_Init(I2Cx, &I2C_InitStruct);
+	I2C_Cmd(I2Cx, ENABLE);
+
+	// Step 2: Initialize GPIO as open drain alternate function
+	RCC_APB2PeriphClockCmd(I2C_GPIO_RCC, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = I2C_PIN_SCL | I2C_PIN_SDA;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_OD;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(I2C_GPIO, &GPIO_InitStruct);
+
+	// Step 3: Interrupt on address match, RXNE, TXE, STOP and errors.
+	// The clock is stretched until a handler has served the event.
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStruct.NVIC_IRQChannel = I2C_EV_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	NVIC_InitStruct.NVIC_IRQChannel = I2C_ER_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	I2Cx->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Update registers from the application (any access type)
+  * @param	First register
+  * @param	Pointer to data
+  * @param	Number of bytes
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_slave_set(uint8_t reg, const void* data, uint8_t len)
+{
+	if ((reg + len) > I2C_SLAVE_REGS)
+	{
+		return;
+	}
+
+	// A master read takes its snapshot in the event handler, so a
+	// multi-byte value is never seen half updated
+	NVIC_DisableIRQ(I2C_EV_IRQn);
+	memcpy(&regs[reg], data, len);
+	NVIC_EnableIRQ(I2C_EV_IRQn);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Read registers from the application (any access type)
+  * @param	First register
+  * @param	Pointer to store data
+  * @param	Number of bytes
+  * @retval	None
+  ******************************************************************************
+  */
+void i2c_slave_get(uint8_t reg, void* data, uint8_t len)
+{
+	if ((reg + len) > I2C_SLAVE_REGS)
+	{
+		return;
+	}
+
+	NVIC_DisableIRQ(I2C_EV_IRQn);
+	memcpy(data, &regs[reg], len);
+	NVIC_EnableIRQ(I2C_EV_IRQn);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	I2C event interrupt handler
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void I2C_EV_IRQHandler(void)
+{
+	uint16_t sr1 = I2Cx->SR1;
+	uint8_t byte;
+
+	if (sr1 & I2C_SR1_ADDR)
+	{
+		// A repeated START ends a preceding write like a STOP does
+		i2c_slave_notify();
+		// Reading SR2 after SR1 clears ADDR
+		if (I2Cx->SR2 & I2C_SR2_TRA)
+		{
+			memcpy(snapshot, regs, sizeof(regs));
+		}
+		else
+		{
+			pointerByte = 1;
+		}
+	}
+
+	if (sr1 & I2C_SR1_RXNE)
+	{
+		byte = I2Cx->DR;
+		if (pointerByte)
+		{
+			pointerByte = 0;
+			pointer = byte % I2C_SLAVE_REGS;
+		}
+		else
+		{
+			// Every write is reported, also when the value is the same
+			// (command registers)
+			if (access[pointer] & I2C_SLAVE_WO)
+			{
+				regs[pointer] = byte;
+				if (!dirty || (pointer < dirtyFirst))
+				{
+					dirtyFirst = pointer;
+				}
+				if (!dirty || (pointer > dirtyLast))
+				{
+					dirtyLast = pointer;
+				}
+				dirty = 1;
+			}
+			pointer = (pointer + 1) % I2C_SLAVE_REGS;
+		}
+	}
+
+	if (sr1 & I2C_SR1_TXE)
+	{
+		// Write-only and unmapped registers read as 0
+		I2Cx->DR = (access[pointer] & I2C_SLAVE_RO) ? snapshot[pointer] : 0;
+		pointer = (pointer + 1) % I2C_SLAVE_REGS;
+	}
+
+	if (sr1 & I2C_SR1_STOPF)
+	{
+		// Reading SR1 then writing CR1 clears STOPF
+		I2Cx->CR1 |= I2C_CR1_PE;
+		i2c_slave_notify();
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	I2C error interrupt handler
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void I2C_ER_IRQHandler(void)
+{
+	uint16_t sr1 = I2Cx->SR1;
+
+	// Error flags are cleared by writing 0
+	I2Cx->SR1 = (uint16_t) ~(I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR);
+
+	if (sr1 & I2C_SR1_AF)
+	{
+		// Master NACKed the last byte of a read. The next byte is already in
+		// DR and was not sent: step the pointer back and flush DR by
+		// disabling the peripheral, otherwise it goes out on the next read.
+		pointer = (pointer + I2C_SLAVE_REGS - 1) % I2C_SLAVE_REGS;
+		I2Cx->CR1 &= ~I2C_CR1_PE;
+		I2Cx->CR1 |= I2C_CR1_PE;
+		// ACK is cleared while PE is 0
+		I2Cx->CR1 |= I2C_CR1_ACK;
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Call change callbacks of the regions written since the last call
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void i2c_slave_notify()
+{
+	uint8_t i, first, last;
+
+	if (!dirty)
+	{
+		return;
+	}
+	dirty = 0;
+
+	for (i = 0; i < regionCount; i++)
+	{
+		const i2c_slave_region_t* region = &regionTable[i];
+
+		if (!region->on_change || (region->count == 0))
+		{
+			continue;
+		}
+		first = (dirtyFirst > region->first) ? dirtyFirst : region->first;
+		last = region->first + region->count - 1;
+		if (dirtyLast < last)
+		{
+			last = dirtyLast;
+		}
+		if (first <= last)
+		{
+			region->on_change(first, last);
+		}
+	}
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file		i2c_slave.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Interrupt driven I2C slave exposing a register map. The master
+	*					writes the register pointer as first byte, further written
+	*					bytes go to consecutive registers, reads continue from the
+	*					pointer. Registers are grouped in regions with read-only,
+	*					write-only or read-write access and an optional callback that
+	*					runs after a write transaction wrote to the region.
+  ******************************************************************************
+  */
+
+#ifndef __I2C_SLAVE_H
+#define __I2C_SLAVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_i2c.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define I2Cx_RCC				RCC_APB1Periph_I2C2
+#define I2Cx						I2C2
+#define I2C_GPIO_RCC		RCC_APB2Periph_GPIOB
+#define I2C_GPIO				GPIOB
+#define I2C_PIN_SDA			GPIO_Pin_11
+#define I2C_PIN_SCL			GPIO_Pin_10
+#define I2C_EV_IRQn			I2C2_EV_IRQn
+#define I2C_ER_IRQn			I2C2_ER_IRQn
+#define I2C_EV_IRQHandler	I2C2_EV_IRQHandler
+#define I2C_ER_IRQHandler	I2C2_ER_IRQHandler
+
+// Size of the register map
+#define I2C_SLAVE_REGS	32
+
+// Register access
+#define I2C_SLAVE_RO		0x01		// Master reads, writes are ignored
+#define I2C_SLAVE_WO		0x02		// Master writes, reads return 0
+#define I2C_SLAVE_RW		(I2C_SLAVE_RO | I2C_SLAVE_WO)
+
+/** Typedefs ---------------------------------------------------------------- */
+// Called from interrupt after a write transaction wrote registers
+// first to last (inclusive) of a region
+typedef void (*i2c_slave_callback_t)(uint8_t first, uint8_t last);
+
+typedef struct
+{
+	uint8_t first;								// First register of the region
+	uint8_t count;								// Number of registers
+	uint8_t access;								// I2C_SLAVE_RO, WO or RW
+	i2c_slave_callback_t on_change;	// May be 0
+} i2c_slave_region_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void i2c_slave_init(uint8_t address, const i2c_slave_region_t* regions, 
+	uint8_t count);
+void i2c_slave_set(uint8_t reg, const void* data, uint8_t len);
+void i2c_slave_get(uint8_t reg, void* data, uint8_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,142 @@
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "delay.h"
+#include "lcd16x2.h"
+#include "i2c_slave.h"
+
+#define SLAVE_ADDRESS		0x08
+
+// Register map
+#define REG_WHO_AM_I		0x00		// RO, always WHO_AM_I_VALUE
+#define REG_CONTROL			0x01		// RW, bit 0 = LED blinking on
+#define REG_STATUS			0x02		// RO, bit 0 = LED state
+#define REG_UPTIME			0x03		// RO, 4 bytes ms since reset, little endian
+#define REG_SCRATCH			0x07		// RW, 9 bytes free for the master
+#define REG_COMMAND			0x10		// WO, 1 byte command
+#define WHO_AM_I_VALUE	0xA5
+
+#define CONTROL_BLINK		0x01
+#define COMMAND_RESET_SCRATCH	0x01
+
+#define LED_GPIO_RCC		RCC_APB2Periph_GPIOC
+#define LED_GPIO				GPIOC
+#define LED_PIN					GPIO_Pin_13
+
+void led_init(void);
+void control_changed(uint8_t first, uint8_t last);
+void command_written(uint8_t first, uint8_t last);
+uint8_t register_pending(void);
+
+const i2c_slave_region_t regions[] =
+{
+	{ REG_WHO_AM_I, 1, I2C_SLAVE_RO, 0 },
+	{ REG_CONTROL, 1, I2C_SLAVE_RW, control_changed },
+	{ REG_STATUS, 5, I2C_SLAVE_RO, 0 },
+	{ REG_SCRATCH, 9, I2C_SLAVE_RW, 0 },
+	{ REG_COMMAND, 1, I2C_SLAVE_WO, command_written },
+};
+
+// Set from the I2C interrupt, handled in the main loop
+__IO uint8_t controlChanged = 1;
+__IO uint8_t commandPending;
+
+int main(void)
+{
+	uint8_t value, blink = 0, led = 0;
+	uint32_t uptime, elapsed, lastToggle = 0;
+	uint8_t scratch[9] = { 0 };
+	
+	DelayInit();
+	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	led_init();
+	
+	// Registers start at 0, only the ID needs a value
+	value = WHO_AM_I_VALUE;
+	i2c_slave_set(REG_WHO_AM_I, &value, 1);
+	i2c_slave_init(SLAVE_ADDRESS, regions, sizeof(regions) / sizeof(regions[0]));
+	
+	while (1)
+	{
+		if (controlChanged)
+		{
+			controlChanged = 0;
+			i2c_slave_get(REG_CONTROL, &value, 1);
+			blink = value & CONTROL_BLINK;
+			// Display LED blinking status
+			lcd16x2_clrscr();
+			if (blink)
+			{
+				lcd16x2_puts("LED Blinking On");
+			}
+			else
+			{
+				lcd16x2_puts("LED Blinking Off");
+			}
+		}
+		
+		if (commandPending)
+		{
+			commandPending = 0;
+			i2c_slave_get(REG_COMMAND, &value, 1);
+			if (value == COMMAND_RESET_SCRATCH)
+			{
+				i2c_slave_set(REG_SCRATCH, scratch, sizeof(scratch));
+			}
+		}
+		
+		// Blink LED at 2 Hz, off while blinking is disabled
+		if ((DelayGetMs() - lastToggle) >= 250)
+		{
+			lastToggle += 250;
+			led = blink ? !led : 0;
+			GPIO_WriteBit(LED_GPIO, LED_PIN, led ? Bit_RESET : Bit_SET);
+		}
+		
+		// Status and uptime are written in one call, a master read of
+		// registers 0x02 to 0x06 always sees a consistent value
+		uptime = DelayGetMs();
+		{
+			uint8_t status[5];
+			
+			status[0] = led;
+			status[1] = uptime;
+			status[2] = uptime >> 8;
+			status[3] = uptime >> 16;
+			status[4] = uptime >> 24;
+			i2c_slave_set(REG_STATUS, status, sizeof(status));
+		}
+		
+		// Sleep until the next LED toggle, the I2C interrupt wakes up earlier
+		elapsed = DelayGetMs() - lastToggle;
+		DelayIdleUntil(register_pending, (elapsed < 250) ? (250 - elapsed) : 0);
+	}
+}
+
+void led_init()
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	
+	RCC_APB2PeriphClockCmd(LED_GPIO_RCC, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = LED_PIN;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_Init(LED_GPIO, &GPIO_InitStruct);
+	// Blue Pill LED is active low
+	GPIO_SetBits(LED_GPIO, LED_PIN);
+}
+
+void control_changed(uint8_t first, uint8_t last)
+{
+	controlChanged = 1;
+}
+
+void command_written(uint8_t first, uint8_t last)
+{
+	commandPending = 1;
+}
+
+uint8_t register_pending()
+{
+	return controlChanged || commandPending;
+}
@@ -9,18 +9,70 @@
 /** Includes ---------------------------------------------------------------- */
 #include "keypad4x4-scanning.h"
 
+/** Private defines --------------------------------------------------------- */
+#define KEYPAD_PIN_COLS		(KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 | \
+	KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3)
+#define KEYPAD_PIN_ROWS		(KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 | \
+	KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3)
+// EXTI line numbers equal pin numbers
+#define KEYPAD_EXTI_ROWS	KEYPAD_PIN_ROWS
+
 GPIO_InitTypeDef _GPIO_InitStructKeypad;
 
+/** Private variables ------------------------------------------------------- */
+static const uint16_t colPins[4] = 
+{
+	KEYPAD_PIN_COL0, KEYPAD_PIN_COL1, KEYPAD_PIN_COL2, KEYPAD_PIN_COL3
+};
+static const uint16_t rowPins[4] = 
+{
+	KEYPAD_PIN_ROW0, KEYPAD_PIN_ROW1, KEYPAD_PIN_ROW2, KEYPAD_PIN_ROW3
+};
+// Key chars by matrix bit (row * 4 + column)
+static const uint8_t keyChars[16] = 
+{
+	'1', '2', '3', 'A',
+	'4', '5', '6', 'B',
+	'7', '8', '9', 'C',
+	'*', '0', '#', 'D'
+};
+// Debounced state and the last raw scan with the time it first appeared
+static __IO uint16_t keyState;
+static uint16_t lastScan;
+static uint32_t lastScanTime;
+static __IO uint32_t ghosts;
+static __IO uint32_t dropped;
+// Event queue, written by the timer interrupt and read by the main loop
+static keypad_event_t queue[KEYPAD_QUEUE_SIZE];
+static __IO uint8_t queueHead;
+static __IO uint8_t queueTail;
+
+/** Private function prototypes --------------------------------------------- */
+static uint16_t KeypadScan(void);
+static uint8_t KeypadIsGhost(uint16_t scan);
+static void KeypadPush(uint16_t changed, uint16_t scan);
+static void KeypadWake(void);
+static void KeypadIdle(void);
+
 /** Public functions -------------------------------------------------------- */
 /**
   ******************************************************************************
-  * @brief	Initialize GPIO pins for keypad.
+  * @brief	Initialize GPIO pins, row EXTI and scan timer for keypad.
   * @param	None
   * @retval	None
   ******************************************************************************
   */
 void KeypadInit()
 {
+	EXTI_InitTypeDef EXTI_InitStruct;
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	uint8_t i;
+	static const uint8_t rowIRQs[4] = 
+	{
+		KEYPAD_IRQn_ROW0, KEYPAD_IRQn_ROW1, KEYPAD_IRQn_ROW2, KEYPAD_IRQn_ROW3
+	};
+	
 	DelayInit();
 	
 	// GPIO clock for keypad columns and rows
@@ -28,94 +80,341 @@ void KeypadInit()
 	RCC_APB2PeriphClockCmd(KEYPAD_RCC_GPIO_ROW, ENABLE);
 	
 	// Configure GPIO as output open drain for keypad columns
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 |
-		KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3;
+	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_COLS;
 	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_Out_OD;
 	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_Init(KEYPAD_GPIO_COL, &_GPIO_InitStructKeypad);
 	
 	// Configure GPIO as input with pull-up resistor for keypad rows
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 |
-		KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3;
+	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_ROWS;
 	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_IPU;
 	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_Init(KEYPAD_GPIO_ROW, &_GPIO_InitStructKeypad);
+	
+	// Connect rows to EXTI, a pressed key pulls its row low
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+	GPIO_EXTILineConfig(KEYPAD_PORTSRC_ROW, KEYPAD_PINSRC_ROW0);
+	GPIO_EXTILineConfig(KEYPAD_PORTSRC_ROW, KEYPAD_PINSRC_ROW1);
+	GPIO_EXTILineConfig(KEYPAD_PORTSRC_ROW, KEYPAD_PINSRC_ROW2);
+	GPIO_EXTILineConfig(KEYPAD_PORTSRC_ROW, KEYPAD_PINSRC_ROW3);
+	EXTI_InitStruct.EXTI_Line = KEYPAD_EXTI_ROWS;
+	EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
+	EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Falling;
+	EXTI_InitStruct.EXTI_LineCmd = DISABLE;
+	EXTI_Init(&EXTI_InitStruct);
+	
+	// Scan timer: 10 kHz counter clock (APB1 timer clock is the core clock
+	// with APB1 prescaler 2), update event every KEYPAD_SCAN_MS
+	RCC_APB1PeriphClockCmd(KEYPAD_RCC_TIM, ENABLE);
+	TIM_TimeBaseInitStruct.TIM_Prescaler = (SystemCoreClock / 10000) - 1;
+	TIM_TimeBaseInitStruct.TIM_Period = (KEYPAD_SCAN_MS * 10) - 1;
+	TIM_TimeBaseInitStruct.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStruct.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInit(KEYPAD_TIM, &TIM_TimeBaseInitStruct);
+	TIM_ClearITPendingBit(KEYPAD_TIM, TIM_IT_Update);
+	TIM_ITConfig(KEYPAD_TIM, TIM_IT_Update, ENABLE);
+	
+	// Row and timer IRQs at lower priority than SysTick
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	for (i = 0; i < 4; i++)
+	{
+		NVIC_InitStruct.NVIC_IRQChannel = rowIRQs[i];
+		NVIC_Init(&NVIC_InitStruct);
+	}
+	NVIC_InitStruct.NVIC_IRQChannel = KEYPAD_TIM_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	
+	keyState = 0;
+	queueHead = 0;
+	queueTail = 0;
+	KeypadIdle();
 }
 
 /**
   ******************************************************************************
-  * @brief	Get which key is pressed by scanning the columns and read the rows.
+  * @brief	Get the first pressed key of the debounced state.
   * @param	None
-  * @retval	Pressed key char value.
+  * @retval	Pressed key char value, KEYPAD_NO_PRESSED if none.
   ******************************************************************************
   */
 uint8_t KeypadGetKey()
 {
-	// Scan column 0 (column 0 pin is grounded, other column pins is open drain)
-	GPIO_ResetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
-	DelayUs(1);
-	// Read rows
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
-		return '1';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
-		return '4';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
-		return '7';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
-		return '*';
-		
-	// Scan column 1 (column 1 pin is grounded, other column pins is open drain)
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
-	GPIO_ResetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
-	DelayUs(1);
-	// Read rows
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
-		return '2';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
-		return '5';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
-		return '8';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
-		return '0';
+	uint16_t state = keyState;
+	uint8_t i;
+	
+	for (i = 0; i < 16; i++)
+	{
+		if (state & (1 << i))
+		{
+			return keyChars[i];
+		}
+	}
+	
+	return KEYPAD_NO_PRESSED;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get the debounced state of all keys.
+  * @param	None
+  * @retval	Key matrix, bit row * 4 + column is set while pressed.
+  ******************************************************************************
+  */
+uint16_t KeypadGetState()
+{
+	return keyState;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Take the oldest key event from the queue.
+  * @param	Pointer to event destination
+  * @retval	1 if an event was taken, 0 if the queue is empty.
+  ******************************************************************************
+  */
+uint8_t KeypadGetEvent(keypad_event_t* event)
+{
+	uint8_t tail = queueTail;
+	
+	if (tail == queueHead)
+	{
+		return 0;
+	}
+	*event = queue[tail];
+	queueTail = (tail + 1) & (KEYPAD_QUEUE_SIZE - 1);
+	
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Check for queued key events without taking one.
+  * @param	None
+  * @retval	1 if the queue is not empty, otherwise 0.
+  ******************************************************************************
+  */
+uint8_t KeypadEventPending()
+{
+	return queueTail != queueHead;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get number of scans ignored because of possible ghost keys.
+  * @param	None
+  * @retval	Ghost scan count.
+  ******************************************************************************
+  */
+uint32_t KeypadGetGhosts()
+{
+	return ghosts;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get number of events lost because the queue was full.
+  * @param	None
+  * @retval	Dropped event count.
+  ******************************************************************************
+  */
+uint32_t KeypadGetDropped()
+{
+	return dropped;
+}
+
+void KEYPAD_IRQHandler_ROW0()
+{
+	KeypadWake();
+}
+
+void KEYPAD_IRQHandler_ROW1()
+{
+	KeypadWake();
+}
+
+void KEYPAD_IRQHandler_ROW2()
+{
+	KeypadWake();
+}
+
+void KEYPAD_IRQHandler_ROW3()
+{
+	KeypadWake();
+}
+
+void KEYPAD_TIM_IRQHandler()
+{
+	uint16_t scan;
+	uint16_t changed;
+	
+	if (TIM_GetITStatus(KEYPAD_TIM, TIM_IT_Update))
+	{
+		TIM_ClearITPendingBit(KEYPAD_TIM, TIM_IT_Update);
 		
-	// Scan column 2 (column 2 pin is grounded, other column pins is open drain)
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
-	GPIO_ResetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
-	DelayUs(1);
-	// Read rows
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
-		return '3';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
-		return '6';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
-		return '9';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
-		return '#';
+		scan = KeypadScan();
+		if (scan != lastScan)
+		{
+			// Not stable yet, remember when this pattern appeared
+			lastScan = scan;
+			lastScanTime = DelayGetMs();
+		}
+		else if (KeypadIsGhost(scan))
+		{
+			// Keep the last state until the pattern is unambiguous
+			ghosts++;
+		}
+		else if (scan != keyState)
+		{
+			changed = scan ^ keyState;
+			keyState = scan;
+			KeypadPush(changed, scan);
+		}
 		
-	// Scan column 3 (column 3 pin is grounded, other column pins is open drain)
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
-	GPIO_ResetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
-	DelayUs(1);
-	// Read rows
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
-		return 'A';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
-		return 'B';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
-		return 'C';
-	if (!GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
-		return 'D';
+		// All released and stable, go back to waiting for a row edge
+		if ((scan == 0) && (keyState == 0))
+		{
+			KeypadIdle();
+		}
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  * @brief	Scan all columns and read the rows.
+  * @param	None
+  * @retval	Key matrix, bit row * 4 + column is set while pressed.
+  ******************************************************************************
+  */
+static uint16_t KeypadScan()
+{
+	uint16_t scan = 0;
+	uint16_t rows;
+	uint8_t col, row;
 	
-	return KEYPAD_NO_PRESSED;
+	for (col = 0; col < 4; col++)
+	{
+		// Ground one column, other column pins are open drain
+		KEYPAD_GPIO_COL->BSRR = (KEYPAD_PIN_COLS & ~colPins[col]) | 
+			((uint32_t)colPins[col] << 16);
+		DelayUs(1);
+		rows = ~KEYPAD_GPIO_ROW->IDR;
+		for (row = 0; row < 4; row++)
+		{
+			if (rows & rowPins[row])
+			{
+				scan |= 1 << ((row * 4) + col);
+			}
+		}
+	}
+	
+	// Ground all columns again so any key pulls its row low
+	KEYPAD_GPIO_COL->BRR = KEYPAD_PIN_COLS;
+	
+	return scan;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Check for possible ghost keys. Without diodes, 3 keys on the
+  *					corners of a rectangle make the 4th corner look pressed, so any
+  *					2 rows sharing 2 or more columns cannot be decoded.
+  * @param	Key matrix
+  * @retval	1 if the matrix is ambiguous, otherwise 0.
+  ******************************************************************************
+  */
+static uint8_t KeypadIsGhost(uint16_t scan)
+{
+	uint8_t r1, r2;
+	uint8_t common;
+	
+	for (r1 = 0; r1 < 3; r1++)
+	{
+		for (r2 = r1 + 1; r2 < 4; r2++)
+		{
+			common = (scan >> (r1 * 4)) & (scan >> (r2 * 4)) & 0x0F;
+			// More than one bit set
+			if (common & (common - 1))
+			{
+				return 1;
+			}
+		}
+	}
+	
+	return 0;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Queue one event per changed key.
+  * @param	Changed keys
+  * @param	New key matrix
+  * @retval	None
+  ******************************************************************************
+  */
+static void KeypadPush(uint16_t changed, uint16_t scan)
+{
+	uint8_t i, head, next;
+	
+	for (i = 0; i < 16; i++)
+	{
+		if (changed & (1 << i))
+		{
+			head = queueHead;
+			next = (head + 1) & (KEYPAD_QUEUE_SIZE - 1);
+			if (next == queueTail)
+			{
+				dropped++;
+				continue;
+			}
+			queue[head].time = lastScanTime;
+			queue[head].key = keyChars[i];
+			queue[head].index = i;
+			queue[head].type = (scan & (1 << i)) ? 
+				KEYPAD_EVENT_PRESS : KEYPAD_EVENT_RELEASE;
+			queueHead = next;
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  * @brief	Row edge: stop listening to the rows and start scanning.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void KeypadWake()
+{
+	EXTI->IMR &= ~KEYPAD_EXTI_ROWS;
+	EXTI->PR = KEYPAD_EXTI_ROWS;
+	
+	lastScan = 0;
+	KEYPAD_TIM->CNT = 0;
+	KEYPAD_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Stop scanning and wait for a row edge with all columns grounded.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void KeypadIdle()
+{
+	KEYPAD_TIM->CR1 &= ~TIM_CR1_CEN;
+	KEYPAD_GPIO_COL->BRR = KEYPAD_PIN_COLS;
+	EXTI->PR = KEYPAD_EXTI_ROWS;
+	EXTI->IMR |= KEYPAD_EXTI_ROWS;
+	
+	// A key pressed after the last scan gave no edge while masked
+	if ((KEYPAD_GPIO_ROW->IDR & KEYPAD_PIN_ROWS) != KEYPAD_PIN_ROWS)
+	{
+		KeypadWake();
+	}
 }
 
 /********************************* END OF FILE ********************************/
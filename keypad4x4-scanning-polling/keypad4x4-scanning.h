@@ -3,6 +3,10 @@
   * @file		keypad4x4-scanning.h
   * @author	Yohanes Erwin Setiawan
   * @date		1 March 2016
+	* @note		Rows wake the driver with EXTI while all columns are driven low.
+	*					A timer then scans the full matrix every KEYPAD_SCAN_MS until all
+	*					keys are released, so nothing runs while the keypad is idle.
+	*					Debounced changes are queued as press and release events.
   ******************************************************************************
   */
 
@@ -17,6 +21,9 @@ extern "C" {
 #include "stm32f10x.h"
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
+#include "stm32f10x_exti.h"
+#include "stm32f10x_tim.h"
+#include "misc.h"
 #include "delay.h"	
 
 // GPIO pin definitions for keypad columns (must on the same GPIO)
@@ -33,12 +40,52 @@ extern "C" {
 #define KEYPAD_PIN_ROW1				GPIO_Pin_2
 #define KEYPAD_PIN_ROW2				GPIO_Pin_1
 #define KEYPAD_PIN_ROW3				GPIO_Pin_0
+// EXTI for keypad rows (one IRQ per row line)
+#define KEYPAD_PORTSRC_ROW		GPIO_PortSourceGPIOA
+#define KEYPAD_PINSRC_ROW0		GPIO_PinSource3
+#define KEYPAD_PINSRC_ROW1		GPIO_PinSource2
+#define KEYPAD_PINSRC_ROW2		GPIO_PinSource1
+#define KEYPAD_PINSRC_ROW3		GPIO_PinSource0
+#define KEYPAD_IRQn_ROW0			EXTI3_IRQn
+#define KEYPAD_IRQn_ROW1			EXTI2_IRQn
+#define KEYPAD_IRQn_ROW2			EXTI1_IRQn
+#define KEYPAD_IRQn_ROW3			EXTI0_IRQn
+#define KEYPAD_IRQHandler_ROW0	EXTI3_IRQHandler
+#define KEYPAD_IRQHandler_ROW1	EXTI2_IRQHandler
+#define KEYPAD_IRQHandler_ROW2	EXTI1_IRQHandler
+#define KEYPAD_IRQHandler_ROW3	EXTI0_IRQHandler
+// Scan timer
+#define KEYPAD_RCC_TIM				RCC_APB1Periph_TIM3
+#define KEYPAD_TIM						TIM3
+#define KEYPAD_TIM_IRQn				TIM3_IRQn
+#define KEYPAD_TIM_IRQHandler	TIM3_IRQHandler
+// Scan period, a change is accepted when 2 scans in a row agree
+#define KEYPAD_SCAN_MS				5
+// Event queue size (power of 2)
+#define KEYPAD_QUEUE_SIZE			16
 // Return value for no key pressed
 #define KEYPAD_NO_PRESSED			0xFF
+// Event types
+#define KEYPAD_EVENT_RELEASE	0
+#define KEYPAD_EVENT_PRESS		1
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint32_t time;						// DelayGetMs() when the change was first seen
+	uint8_t key;							// Key char
+	uint8_t index;						// Matrix bit, row * 4 + column
+	uint8_t type;							// KEYPAD_EVENT_PRESS or KEYPAD_EVENT_RELEASE
+} keypad_event_t;
 
 /** Public function prototypes ---------------------------------------------- */
 void KeypadInit(void);
 uint8_t KeypadGetKey(void);
+uint16_t KeypadGetState(void);
+uint8_t KeypadGetEvent(keypad_event_t* event);
+uint8_t KeypadEventPending(void);
+uint32_t KeypadGetGhosts(void);
+uint32_t KeypadGetDropped(void);
 
 #ifdef __cplusplus
 }
@@ -5,25 +5,54 @@
 #include "lcd16x2.h"
 #include "keypad4x4-scanning.h"
 
-uint8_t key;
+void LCD_PrintState(uint16_t state);
+
+keypad_event_t event;
 
 int main(void)
 {
 	DelayInit();
 	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	// Set System Timer IRQ at higher priority than keypad IRQs
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
 	KeypadInit();
 	
 	while (1)
 	{
-		// Get key pressed
-		key = KeypadGetKey();
-		
-		// Display pressed char to LCD
-		if (key != KEYPAD_NO_PRESSED)
+		// Display the last event and all keys held down (chords)
+		while (KeypadGetEvent(&event))
 		{
 			lcd16x2_gotoxy(0, 0);
-			lcd16x2_putc(key);
-			DelayMs(250);
+			lcd16x2_putc(event.key);
+			lcd16x2_puts((event.type == KEYPAD_EVENT_PRESS) ? 
+				" pressed " : " released");
+			LCD_PrintState(KeypadGetState());
 		}
+		
+		// Nothing to do until a key changes
+		DelayIdleUntil(KeypadEventPending, DELAY_IDLE_FOREVER);
+	}
+}
+
+void LCD_PrintState(uint16_t state)
+{
+	const char keys[16] = "123A456B789C*0#D";
+	char line[17];
+	uint8_t i, n = 0;
+	
+	for (i = 0; i < 16; i++)
+	{
+		if (state & (1 << i))
+		{
+			line[n++] = keys[i];
+		}
+	}
+	while (n < 16)
+	{
+		line[n++] = ' ';
 	}
+	line[n] = '\0';
+	lcd16x2_gotoxy(0, 1);
+	lcd16x2_puts(line);
 }
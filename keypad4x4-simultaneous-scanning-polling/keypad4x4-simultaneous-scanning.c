@@ -9,7 +9,49 @@
 /** Includes ---------------------------------------------------------------- */
 #include "keypad4x4-simultaneous-scanning.h"
 
-GPIO_InitTypeDef _GPIO_InitStructKeypad;
+/** Private defines --------------------------------------------------------- */
+#define KEYPAD_PIN_COLS		(KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 | \
+	KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3)
+#define KEYPAD_PIN_ROWS		(KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 | \
+	KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3)
+// CRL/CRH pin configs: output push-pull 2 MHz, input with pull-up/down
+#define KEYPAD_CR_OUT			0x2
+#define KEYPAD_CR_IN			0x8
+
+/** Private variables ------------------------------------------------------- */
+// Key chars by matrix bit (row * 4 + column)
+static const uint8_t keyChars[16] = 
+{
+	KEYPAD_ROW0_COL0, KEYPAD_ROW0_COL1, KEYPAD_ROW0_COL2, KEYPAD_ROW0_COL3,
+	KEYPAD_ROW1_COL0, KEYPAD_ROW1_COL1, KEYPAD_ROW1_COL2, KEYPAD_ROW1_COL3,
+	KEYPAD_ROW2_COL0, KEYPAD_ROW2_COL1, KEYPAD_ROW2_COL2, KEYPAD_ROW2_COL3,
+	KEYPAD_ROW3_COL0, KEYPAD_ROW3_COL1, KEYPAD_ROW3_COL2, KEYPAD_ROW3_COL3
+};
+// Pin nibble (ROW0/COL0 in bit 3) to index bits (ROW0/COL0 in bit 0)
+static const uint8_t nibbleReverse[16] = 
+{
+	0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 
+	0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+// Row pin nibble to bit 0 of each active row's nibble in the matrix,
+// multiplied by the column bits it gives the key matrix
+static const uint16_t rowSpread[16] = 
+{
+	0x0000, 0x1000, 0x0100, 0x1100, 0x0010, 0x1010, 0x0110, 0x1110, 
+	0x0001, 0x1001, 0x0101, 0x1101, 0x0011, 0x1011, 0x0111, 0x1111
+};
+// CRL/CRH values of the keypad pins for both scan phases and their masks
+static uint32_t crMask[2];
+static uint32_t crDriveCols[2];
+static uint32_t crDriveRows[2];
+// Debounced state and vertical counter bits (bit 0 and bit 1 of 16 counters)
+static uint16_t keyState;
+static uint16_t count0;
+static uint16_t count1;
+static uint32_t scanCycles;
+
+/** Private function prototypes --------------------------------------------- */
+static void KeypadPinConfig(uint16_t pins, uint32_t config, uint32_t* cr);
 
 /** Public functions -------------------------------------------------------- */
 /**
@@ -26,118 +68,131 @@ void KeypadInit()
 	// GPIO clock for keypad columns and rows
 	RCC_APB2PeriphClockCmd(KEYPAD_RCC_GPIO_COL, ENABLE);
 	RCC_APB2PeriphClockCmd(KEYPAD_RCC_GPIO_ROW, ENABLE);
+	
+	// Precompute the port configuration of both scan phases, a scan then
+	// only writes CRL/CRH instead of calling GPIO_Init()
+	KeypadPinConfig(KEYPAD_PIN_COLS | KEYPAD_PIN_ROWS, 0xF, crMask);
+	KeypadPinConfig(KEYPAD_PIN_COLS, KEYPAD_CR_OUT, crDriveCols);
+	KeypadPinConfig(KEYPAD_PIN_ROWS, KEYPAD_CR_IN, crDriveCols);
+	KeypadPinConfig(KEYPAD_PIN_ROWS, KEYPAD_CR_OUT, crDriveRows);
+	KeypadPinConfig(KEYPAD_PIN_COLS, KEYPAD_CR_IN, crDriveRows);
+	
+	// All keys released, counters at their reset value
+	keyState = 0;
+	count0 = 0xFFFF;
+	count1 = 0xFFFF;
 }
 
 /**
   ******************************************************************************
-  * @brief	Get which key is pressed by scanning the columns and read the rows.
+  * @brief	Read the keypad and debounce all keys at once.
   * @param	None
-  * @retval	Pressed key char value.
+  * @retval	Debounced key matrix, bit row * 4 + column is set while pressed.
   ******************************************************************************
   */
-uint8_t KeypadGetKey()
+uint16_t KeypadScan()
 {
-	// For store keypad column and row bits value
-	// Column bits stored in high nibble, row bits stored in low nibble
-	// cols: 0b C0C1C2C3 0000
-	// rows: 0b 0000 R0R1R2R3
-	uint8_t cols = 0, rows = 0;
-		
-	/* Drive all columns with logic high, then read all rows value */
-	// Configure GPIO as output push-pull for keypad columns
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 |
-		KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3;
-	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_Out_PP;
-	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(KEYPAD_GPIO_COL, &_GPIO_InitStructKeypad);
-	// Configure GPIO as input with pull-down resistor for keypad rows
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 |
-		KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3;
-	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_IPD;
-	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(KEYPAD_GPIO_ROW, &_GPIO_InitStructKeypad);
-	// Drive all columns
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
-	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
+	uint32_t start = DelayGetCycles();
+	uint8_t cols, rows;
+	uint16_t sample, changed;
+	
+	/* Drive all columns high, read rows with pull-down */
+	// Both GPIOs are the same port (see header)
+	KEYPAD_GPIO_COL->BSRR = KEYPAD_PIN_COLS | ((uint32_t)KEYPAD_PIN_ROWS << 16);
+	KEYPAD_GPIO_COL->CRL = (KEYPAD_GPIO_COL->CRL & ~crMask[0]) | crDriveCols[0];
+	KEYPAD_GPIO_COL->CRH = (KEYPAD_GPIO_COL->CRH & ~crMask[1]) | crDriveCols[1];
 	DelayUs(1);
-	// Read all rows
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
-		rows |= (1 << 3);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
-		rows |= (1 << 2);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
-		rows |= (1 << 1);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
-		rows |= (1 << 0);
+	rows = (KEYPAD_GPIO_ROW->IDR >> KEYPAD_ROW_SHIFT) & 0x0F;
 	
-	/* Drive all rows with logic high, then read all columns value */
-	// Configure GPIO as output push-pull for keypad rows
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 |
-		KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3;
-	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_Out_PP;
-	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(KEYPAD_GPIO_ROW, &_GPIO_InitStructKeypad);
-	// Configure GPIO as input with pull-down resistor for keypad columns
-	_GPIO_InitStructKeypad.GPIO_Pin = KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 |
-		KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3;
-	_GPIO_InitStructKeypad.GPIO_Mode = GPIO_Mode_IPD;
-	_GPIO_InitStructKeypad.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(KEYPAD_GPIO_COL, &_GPIO_InitStructKeypad);	
-	// Drive all rows
-	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0);
-	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1);
-	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2);
-	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3);
+	/* Drive all rows high, read columns with pull-down */
+	KEYPAD_GPIO_ROW->BSRR = KEYPAD_PIN_ROWS | ((uint32_t)KEYPAD_PIN_COLS << 16);
+	KEYPAD_GPIO_ROW->CRL = (KEYPAD_GPIO_ROW->CRL & ~crMask[0]) | crDriveRows[0];
+	KEYPAD_GPIO_ROW->CRH = (KEYPAD_GPIO_ROW->CRH & ~crMask[1]) | crDriveRows[1];
 	DelayUs(1);
-	// Read all columns
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0))
-		cols |= (1 << 7);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1))
-		cols |= (1 << 6);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2))
-		cols |= (1 << 5);
-	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3))
-		cols |= (1 << 4);
+	cols = (KEYPAD_GPIO_COL->IDR >> KEYPAD_COL_SHIFT) & 0x0F;
+	
+	// Key matrix, every active row gets all active columns
+	sample = rowSpread[rows] * nibbleReverse[cols];
+	
+	/* Vertical counters: a key's counter runs while its sample differs
+	   from the debounced state and is reset when they agree again.
+	   The state toggles when the counter wraps after 4 scans. */
+	changed = sample ^ keyState;
+	count0 = ~(count0 & changed);
+	count1 = count0 ^ (count1 & changed);
+	changed &= count0 & count1;
+	keyState ^= changed;
+	
+	scanCycles = DelayGetCycles() - start;
+	
+	return keyState;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get which key is pressed from the debounced state.
+  * @param	None
+  * @retval	Pressed key char value, KEYPAD_NO_PRESSED if none or more than
+  *					one key is pressed.
+  ******************************************************************************
+  */
+uint8_t KeypadGetKey()
+{
+	// Exactly one bit set
+	if ((keyState == 0) || (keyState & (keyState - 1)))
+	{
+		return KEYPAD_NO_PRESSED;
+	}
+	
+	return keyChars[31 - __CLZ(keyState)];
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get the debounced state of all keys. With more than one key
+  *					pressed, keys on the crossings of their rows and columns are
+  *					reported pressed too.
+  * @param	None
+  * @retval	Key matrix, bit row * 4 + column is set while pressed.
+  ******************************************************************************
+  */
+uint16_t KeypadGetState()
+{
+	return keyState;
+}
+
+/**
+  ******************************************************************************
+  * @brief	Get how long the last KeypadScan() took.
+  * @param	None
+  * @retval	Core clock cycles.
+  ******************************************************************************
+  */
+uint32_t KeypadGetScanCycles()
+{
+	return scanCycles;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  * @brief	Set the 4-bit config field of pins in CRL/CRH images.
+  * @param	Pins
+  * @param	Config field (MODE and CNF bits)
+  * @param	CRL (index 0) and CRH (index 1) images
+  * @retval	None
+  ******************************************************************************
+  */
+static void KeypadPinConfig(uint16_t pins, uint32_t config, uint32_t* cr)
+{
+	uint8_t pin;
 	
-	/* Return pressed key char */
-	switch (cols | rows)
+	for (pin = 0; pin < 16; pin++)
 	{
-		case 0x88:
-			return KEYPAD_ROW0_COL0;
-		case 0x48:
-			return KEYPAD_ROW0_COL1;
-		case 0x28:
-			return KEYPAD_ROW0_COL2;
-		case 0x18:
-			return KEYPAD_ROW0_COL3;
-		case 0x84:
-			return KEYPAD_ROW1_COL0;
-		case 0x44:
-			return KEYPAD_ROW1_COL1;
-		case 0x24:
-			return KEYPAD_ROW1_COL2;
-		case 0x14:
-			return KEYPAD_ROW1_COL3;
-		case 0x82:
-			return KEYPAD_ROW2_COL0;
-		case 0x42:
-			return KEYPAD_ROW2_COL1;
-		case 0x22:
-			return KEYPAD_ROW2_COL2;
-		case 0x12:
-			return KEYPAD_ROW2_COL3;
-		case 0x81:
-			return KEYPAD_ROW3_COL0;
-		case 0x41:
-			return KEYPAD_ROW3_COL1;
-		case 0x21:
-			return KEYPAD_ROW3_COL2;
-		case 0x11:
-			return KEYPAD_ROW3_COL3;
-		default:
-			return KEYPAD_NO_PRESSED;
+		if (pins & (1 << pin))
+		{
+			cr[pin / 8] |= config << ((pin % 8) * 4);
+		}
 	}
 }
 
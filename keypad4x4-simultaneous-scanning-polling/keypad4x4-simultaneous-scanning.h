@@ -3,6 +3,9 @@
   * @file		keypad4x4-simultaneous-scanning.h
   * @author	Yohanes Erwin Setiawan
   * @date		3 March 2016
+	* @note		Call KeypadScan() every KEYPAD_SCAN_MS. Each key is debounced by
+	*					a 2-bit vertical counter, a change is accepted after 4 scans
+	*					in a row agree.
   ******************************************************************************
   */
 
@@ -33,6 +36,12 @@ extern "C" {
 #define KEYPAD_PIN_ROW1				GPIO_Pin_2
 #define KEYPAD_PIN_ROW2				GPIO_Pin_1
 #define KEYPAD_PIN_ROW3				GPIO_Pin_0
+// Row and column pins must be 4 consecutive pins, ROW0 and COL0 on the
+// highest one. Shift is the pin number of ROW3 and COL3.
+#define KEYPAD_ROW_SHIFT			0
+#define KEYPAD_COL_SHIFT			4
+// Scan period in ms
+#define KEYPAD_SCAN_MS				5
 // Return value for key pressed
 #define KEYPAD_NO_PRESSED			0xFF
 #define KEYPAD_ROW0_COL0			'1'
@@ -54,7 +63,10 @@ extern "C" {
 
 /** Public function prototypes ---------------------------------------------- */
 void KeypadInit(void);
+uint16_t KeypadScan(void);
 uint8_t KeypadGetKey(void);
+uint16_t KeypadGetState(void);
+uint32_t KeypadGetScanCycles(void);
 
 #ifdef __cplusplus
 }
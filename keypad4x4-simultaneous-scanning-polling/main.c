@@ -4,8 +4,17 @@
 #include "delay.h"
 #include "lcd16x2.h"
 #include "keypad4x4-simultaneous-scanning.h"
+#include "fmt.h"
 
+uint32_t Keypad_SPLScanCycles(void);
+void LCD_PrintScanCost(uint32_t before, uint32_t after);
+
+GPIO_InitTypeDef GPIO_InitStruct;
 uint8_t key;
+uint8_t lastKey = KEYPAD_NO_PRESSED;
+// Scan cost with GPIO_Init() per phase and with direct register access
+uint32_t splCycles;
+uint32_t scanCycles;
 
 int main(void)
 {
@@ -13,17 +22,100 @@ int main(void)
 	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
 	KeypadInit();
 	
+	// Compare scan cost, both include the two 1 us settle delays
+	splCycles = Keypad_SPLScanCycles();
+	KeypadScan();
+	scanCycles = KeypadGetScanCycles();
+	LCD_PrintScanCost(splCycles, scanCycles);
+	
 	while (1)
 	{
-		// Get key pressed
+		// Get debounced key pressed
+		KeypadScan();
 		key = KeypadGetKey();
 		
-		// Display pressed char to LCD
-		if (key != KEYPAD_NO_PRESSED)
+		// Display newly pressed char to LCD
+		if (key != lastKey)
 		{
-			lcd16x2_gotoxy(0, 0);
-			lcd16x2_putc(key);
-			DelayMs(250);
+			lastKey = key;
+			if (key != KEYPAD_NO_PRESSED)
+			{
+				lcd16x2_gotoxy(0, 0);
+				lcd16x2_putc(key);
+			}
 		}
+		
+		DelaySleepMs(KEYPAD_SCAN_MS);
 	}
 }
+
+// Previous scan: reconfigure with GPIO_Init() and read pin by pin
+uint32_t Keypad_SPLScanCycles()
+{
+	uint32_t start = DelayGetCycles();
+	uint8_t cols = 0, rows = 0;
+	
+	GPIO_InitStruct.GPIO_Pin = KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 |
+		KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_Init(KEYPAD_GPIO_COL, &GPIO_InitStruct);
+	GPIO_InitStruct.GPIO_Pin = KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 |
+		KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPD;
+	GPIO_Init(KEYPAD_GPIO_ROW, &GPIO_InitStruct);
+	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0);
+	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1);
+	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2);
+	GPIO_SetBits(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3);
+	DelayUs(1);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0))
+		rows |= (1 << 3);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1))
+		rows |= (1 << 2);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2))
+		rows |= (1 << 1);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3))
+		rows |= (1 << 0);
+	
+	GPIO_InitStruct.GPIO_Pin = KEYPAD_PIN_ROW0 | KEYPAD_PIN_ROW1 |
+		KEYPAD_PIN_ROW2 | KEYPAD_PIN_ROW3;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_Init(KEYPAD_GPIO_ROW, &GPIO_InitStruct);
+	GPIO_InitStruct.GPIO_Pin = KEYPAD_PIN_COL0 | KEYPAD_PIN_COL1 |
+		KEYPAD_PIN_COL2 | KEYPAD_PIN_COL3;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPD;
+	GPIO_Init(KEYPAD_GPIO_COL, &GPIO_InitStruct);	
+	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW0);
+	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW1);
+	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW2);
+	GPIO_SetBits(KEYPAD_GPIO_ROW, KEYPAD_PIN_ROW3);
+	DelayUs(1);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL0))
+		cols |= (1 << 7);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL1))
+		cols |= (1 << 6);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL2))
+		cols |= (1 << 5);
+	if (GPIO_ReadInputDataBit(KEYPAD_GPIO_COL, KEYPAD_PIN_COL3))
+		cols |= (1 << 4);
+	
+	// Keep the result so the reads are not optimized away
+	key = cols | rows;
+	
+	return DelayGetCycles() - start;
+}
+
+void LCD_PrintScanCost(uint32_t before, uint32_t after)
+{
+	char line[17];
+	uint8_t n;
+	
+	n = fmt_str(line, "cy", 2);
+	n += fmt_dec(&line[n], before, 6, FMT_PAD_SPACE);
+	n += fmt_str(&line[n], " ->", 3);
+	n += fmt_dec(&line[n], after, 5, FMT_PAD_SPACE);
+	line[n] = '\0';
+	lcd16x2_gotoxy(0, 1);
+	lcd16x2_puts(line);
+}
@@ -3,6 +3,7 @@
 #include "stm32f10x_gpio.h"
 #include "stm32f10x_tim.h"
 #include "delay.h"
+#include "swtimer.h"
 
 #define SS_DIGIT				4
 #define RCC_GPIO_DIG		RCC_APB2Periph_GPIOA
@@ -28,11 +29,15 @@ const uint8_t font[10] =
 	0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70, 0x7F, 0x7B
 };
 uint8_t buffer[4];
+// Numbers shown alternately every 1 s
+const uint16_t numbers[2] = { 505, 2016 };
+swtimer_t number_timer;
 
 void TIM2_INT_Init(void);
 void Led7SegmentInit(void);
 void ScreenUpdate(void);
 void PrintNumber(uint16_t number);
+void NextNumber(void* arg);
 
 void TIM2_IRQHandler()
 {
@@ -53,12 +58,16 @@ int main(void)
 	TIM2_INT_Init();
 	Led7SegmentInit();
 	
+	// Switch displayed number every 1 s
+	swtimer_init();
+	swtimer_create(&number_timer, NextNumber, 0);
+	swtimer_start(&number_timer, 0, 1000);
+	
 	while (1)
 	{
-		PrintNumber(505);
-		DelayMs(1000);
-		PrintNumber(2016);
-		DelayMs(1000);
+		swtimer_process();
+		// Sleep until the next timer is due or an interrupt occurs
+		DelayIdle(swtimer_idle_ms());
 	}
 }
 
@@ -145,3 +154,11 @@ void PrintNumber(uint16_t number)
 	buffer[2] = number % 100 / 10;
 	buffer[3] = number % 10;
 }
+
+void NextNumber(void* arg)
+{
+	static uint8_t index = 0;
+	
+	PrintNumber(numbers[index]);
+	index ^= 1;
+}
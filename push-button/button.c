@@ -0,0 +1,323 @@
+/**
+  ******************************************************************************
+  * @file		button.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "button.h"
+
+/** Private defines --------------------------------------------------------- */
+#define BUTTON_LONG_TICKS		(BUTTON_LONG_MS / BUTTON_TICK_MS)
+#define BUTTON_REPEAT_TICKS	(BUTTON_REPEAT_MS / BUTTON_TICK_MS)
+#define BUTTON_DOUBLE_TICKS	(BUTTON_DOUBLE_MS / BUTTON_TICK_MS)
+
+/** Private variables ------------------------------------------------------- */
+// Configured inputs and the inputs that read 0 when pressed
+static uint32_t inputMask;
+static uint32_t invertMask;
+// Debounced state and vertical counter bits (bit 0 and bit 1 of 32 counters)
+static __IO uint32_t keyState;
+static uint32_t count0;
+static uint32_t count1;
+// Inputs past long press, waiting for a second click, or on a double click
+static uint32_t longMask;
+static uint32_t gapMask;
+static uint32_t doubleMask;
+// Ticks held (until the next long/repeat event) and ticks since release
+static uint16_t held[32];
+static uint16_t gap[32];
+static uint32_t ticks;
+static uint8_t sleepWhenIdle;
+// Event queue, written by the timer interrupt and read by the main loop
+static button_event_t queue[BUTTON_QUEUE_SIZE];
+static __IO uint8_t queueHead;
+static __IO uint8_t queueTail;
+static __IO uint32_t dropped;
+
+/** Private function prototypes --------------------------------------------- */
+static void button_push(uint8_t input, uint8_t type);
+static void button_init_pins(GPIO_TypeDef* gpio, uint16_t pins, 
+	uint16_t active_low);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Configure input pins and start the tick timer
+  * @param	Inputs to debounce, see BUTTON_LO() and BUTTON_HI()
+  * @param	Inputs that are active low (get pull-up, others pull-down)
+  * @retval	None
+  ******************************************************************************
+  */
+void button_init(uint32_t inputs, uint32_t active_low)
+{
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+
+	inputMask = inputs;
+	invertMask = active_low & inputs;
+	keyState = 0;
+	count0 = 0xFFFFFFFF;
+	count1 = 0xFFFFFFFF;
+	longMask = 0;
+	gapMask = 0;
+	doubleMask = 0;
+	queueHead = 0;
+	queueTail = 0;
+
+	// Step 1: Initialize GPIO as input with pull-up or pull-down
+	RCC_APB2PeriphClockCmd(BUTTON_RCC_GPIO, ENABLE);
+	button_init_pins(BUTTON_GPIO_LO, inputs, active_low);
+	button_init_pins(BUTTON_GPIO_HI, inputs >> 16, active_low >> 16);
+
+	// Step 2: Initialize tick timer, 10 kHz counter clock (APB1 timer clock
+	// is the core clock with APB1 prescaler 2)
+	RCC_APB1PeriphClockCmd(BUTTON_RCC_TIM, ENABLE);
+	TIM_TimeBaseInitStruct.TIM_Prescaler = (SystemCoreClock / 10000) - 1;
+	TIM_TimeBaseInitStruct.TIM_Period = (BUTTON_TICK_MS * 10) - 1;
+	TIM_TimeBaseInitStruct.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStruct.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInit(BUTTON_TIM, &TIM_TimeBaseInitStruct);
+	TIM_ClearITPendingBit(BUTTON_TIM, TIM_IT_Update);
+	TIM_ITConfig(BUTTON_TIM, TIM_IT_Update, ENABLE);
+	TIM_Cmd(BUTTON_TIM, ENABLE);
+
+	// Step 3: Initialize NVIC, lower priority than SysTick
+	NVIC_InitStruct.NVIC_IRQChannel = BUTTON_TIM_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Take the oldest event from the queue
+  * @param	Pointer to event destination
+  * @retval	1 if an event was taken, 0 if the queue is empty
+  ******************************************************************************
+  */
+uint8_t button_get_event(button_event_t* event)
+{
+	uint8_t tail = queueTail;
+
+	if (tail == queueHead)
+	{
+		return 0;
+	}
+	*event = queue[tail];
+	queueTail = (tail + 1) & (BUTTON_QUEUE_SIZE - 1);
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check for queued events without taking one
+  * @param	None
+  * @retval	1 if the queue is not empty, otherwise 0
+  ******************************************************************************
+  */
+uint8_t button_event_pending()
+{
+	return queueTail != queueHead;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the debounced state of all inputs
+  * @param	None
+  * @retval	Input bits, set while pressed
+  ******************************************************************************
+  */
+uint32_t button_get_state()
+{
+	return keyState;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of events lost because the queue was full
+  * @param	None
+  * @retval	Dropped event count
+  ******************************************************************************
+  */
+uint32_t button_get_dropped()
+{
+	return dropped;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Stop the tick timer while all inputs are released and settled.
+  *					button_wake() must then be called on input activity, e.g.
+  *					from an EXTI handler.
+  * @param	1 to enable, 0 to keep ticking
+  * @retval	None
+  ******************************************************************************
+  */
+void button_sleep_when_idle(uint8_t enable)
+{
+	sleepWhenIdle = enable;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Restart the tick timer, safe to call from interrupts
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void button_wake()
+{
+	BUTTON_TIM->CR1 |= TIM_CR1_CEN;
+}
+
+void BUTTON_TIM_IRQHandler()
+{
+	uint32_t sample, changed, pressed, released, active;
+	uint8_t i;
+
+	if (!(BUTTON_TIM->SR & TIM_SR_UIF))
+	{
+		return;
+	}
+	BUTTON_TIM->SR = ~TIM_SR_UIF;
+	ticks++;
+
+	// Both ports in one word, pressed inputs read as 1
+	sample = (BUTTON_GPIO_LO->IDR & 0xFFFF) | (BUTTON_GPIO_HI->IDR << 16);
+	sample = (sample ^ invertMask) & inputMask;
+
+	// Vertical counters: an input's counter runs while its sample differs
+	// from the debounced state and is reset when they agree again.
+	// The state toggles when the counter wraps after 4 ticks.
+	changed = sample ^ keyState;
+	count0 = ~(count0 & changed);
+	count1 = count0 ^ (count1 & changed);
+	changed &= count0 & count1;
+	keyState ^= changed;
+	pressed = changed & keyState;
+	released = changed & ~keyState;
+
+	// New presses, a press soon after a click is a double click
+	active = pressed;
+	while (active)
+	{
+		i = 31 - __CLZ(active);
+		active &= ~(1UL << i);
+		button_push(i, BUTTON_EVENT_PRESS);
+		if (gapMask & (1UL << i))
+		{
+			button_push(i, BUTTON_EVENT_DOUBLE);
+			doubleMask |= 1UL << i;
+		}
+		held[i] = 0;
+	}
+	gapMask &= ~pressed;
+
+	// Held inputs: long press once, then repeats
+	active = keyState & ~pressed;
+	while (active)
+	{
+		i = 31 - __CLZ(active);
+		active &= ~(1UL << i);
+		if (++held[i] >= BUTTON_LONG_TICKS)
+		{
+			button_push(i, (longMask & (1UL << i)) ? 
+				BUTTON_EVENT_REPEAT : BUTTON_EVENT_LONG);
+			longMask |= 1UL << i;
+			held[i] = BUTTON_LONG_TICKS - BUTTON_REPEAT_TICKS;
+		}
+	}
+
+	// Waiting for a second click
+	active = gapMask;
+	while (active)
+	{
+		i = 31 - __CLZ(active);
+		active &= ~(1UL << i);
+		if (++gap[i] >= BUTTON_DOUBLE_TICKS)
+		{
+			gapMask &= ~(1UL << i);
+		}
+	}
+
+	// Releases, only a short single click can start a double click
+	active = released;
+	while (active)
+	{
+		i = 31 - __CLZ(active);
+		active &= ~(1UL << i);
+		button_push(i, BUTTON_EVENT_RELEASE);
+		gap[i] = 0;
+	}
+	gapMask |= released & ~(longMask | doubleMask);
+	longMask &= ~released;
+	doubleMask &= ~released;
+
+	// Nothing pressed, bouncing or timing, wait for button_wake()
+	if (sleepWhenIdle && !keyState && !gapMask && !(sample ^ keyState))
+	{
+		BUTTON_TIM->CR1 &= ~TIM_CR1_CEN;
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Add an event to the queue
+  * @param	Input bit number
+  * @param	Event type
+  * @retval	None
+  ******************************************************************************
+  */
+static void button_push(uint8_t input, uint8_t type)
+{
+	uint8_t head = queueHead;
+	uint8_t next = (head + 1) & (BUTTON_QUEUE_SIZE - 1);
+
+	if (next == queueTail)
+	{
+		dropped++;
+		return;
+	}
+	queue[head].tick = ticks;
+	queue[head].input = input;
+	queue[head].type = type;
+	queueHead = next;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Configure the inputs of one port
+  * @param	GPIO port
+  * @param	Pins to configure
+  * @param	Pins that are active low
+  * @retval	None
+  ******************************************************************************
+  */
+static void button_init_pins(GPIO_TypeDef* gpio, uint16_t pins, 
+	uint16_t active_low)
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	if (pins & active_low)
+	{
+		GPIO_InitStruct.GPIO_Pin = pins & active_low;
+		GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
+		GPIO_Init(gpio, &GPIO_InitStruct);
+	}
+	if (pins & ~active_low)
+	{
+		GPIO_InitStruct.GPIO_Pin = pins & ~active_low;
+		GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPD;
+		GPIO_Init(gpio, &GPIO_InitStruct);
+	}
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,84 @@
+/**
+  ******************************************************************************
+  * @file		button.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Timer driven debounce for up to 32 inputs on two GPIO ports.
+	*					Both ports are sampled as a whole every BUTTON_TICK_MS and all
+	*					inputs are debounced at once by 2-bit vertical counters, so the
+	*					cost of a tick does not depend on the number of inputs. Only
+	*					inputs that are held or wait for a double click get per-input
+	*					work for gesture timing. Events are read from a queue.
+  ******************************************************************************
+  */
+
+#ifndef __BUTTON_H
+#define __BUTTON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_tim.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Ports sampled into input bits 0-15 and 16-31
+#define BUTTON_GPIO_LO				GPIOA
+#define BUTTON_GPIO_HI				GPIOB
+#define BUTTON_RCC_GPIO				(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB)
+// Input bit of a pin on each port
+#define BUTTON_LO(pin)				((uint32_t)(pin))
+#define BUTTON_HI(pin)				((uint32_t)(pin) << 16)
+
+// Tick timer
+#define BUTTON_RCC_TIM				RCC_APB1Periph_TIM3
+#define BUTTON_TIM						TIM3
+#define BUTTON_TIM_IRQn				TIM3_IRQn
+#define BUTTON_TIM_IRQHandler	TIM3_IRQHandler
+
+// Timing in ms, a change is accepted after 4 ticks in a row agree
+#define BUTTON_TICK_MS				5
+#define BUTTON_LONG_MS				800		// Hold time until long press
+#define BUTTON_REPEAT_MS			200		// Repeat period after long press
+#define BUTTON_DOUBLE_MS			300		// Max release time between 2 clicks
+
+// Event queue size (power of 2)
+#define BUTTON_QUEUE_SIZE			16
+
+// Event types
+#define BUTTON_EVENT_PRESS		0
+#define BUTTON_EVENT_RELEASE	1
+#define BUTTON_EVENT_LONG			2
+#define BUTTON_EVENT_REPEAT		3
+#define BUTTON_EVENT_DOUBLE		4		// Follows the press of the second click
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint32_t tick;						// Tick count, stops while the tick sleeps
+	uint8_t input;						// Input bit number (0 to 31)
+	uint8_t type;
+} button_event_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void button_init(uint32_t inputs, uint32_t active_low);
+uint8_t button_get_event(button_event_t* event);
+uint8_t button_event_pending(void);
+uint32_t button_get_state(void);
+uint32_t button_get_dropped(void);
+void button_sleep_when_idle(uint8_t enable);
+void button_wake(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -1,8 +1,10 @@
 #include "stm32f10x.h"
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
+#include "button.h"
 
 GPIO_InitTypeDef GPIO_InitStruct;
+button_event_t event;
 
 int main(void)
 {
@@ -14,25 +16,33 @@ int main(void)
 	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_OD;
 	GPIO_Init(GPIOA, &GPIO_InitStruct);
+	GPIO_SetBits(GPIOA, GPIO_Pin_0);
 	
-	// Cofigure PA1 as input with internal pull-up resistor
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_1;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
-	GPIO_Init(GPIOA, &GPIO_InitStruct);
+	// Debounce PA1 (input with internal pull-up resistor, active low)
+	button_init(BUTTON_LO(GPIO_Pin_1), BUTTON_LO(GPIO_Pin_1));
 	
 	while (1)
 	{
-		// If button on PA1 is pressed (button circuit is active low)
-		if (!(GPIO_ReadInputData(GPIOA) & GPIO_Pin_1))
+		while (button_get_event(&event))
 		{
-			// Turn on LED on PA0 (LED circuit is active low)
-			GPIO_ResetBits(GPIOA, GPIO_Pin_0);
+			if (event.type == BUTTON_EVENT_PRESS)
+			{
+				// Turn on LED on PA0 (LED circuit is active low)
+				GPIO_ResetBits(GPIOA, GPIO_Pin_0);
+			}
+			else if (event.type == BUTTON_EVENT_RELEASE)
+			{
+				// Turn off LED on PA0
+				GPIO_SetBits(GPIOA, GPIO_Pin_0);
+			}
 		}
-		else
+		// Sleep until the next button tick, check the queue with interrupts
+		// masked so an event queued just before WFI is not slept through
+		__disable_irq();
+		if (!button_event_pending())
 		{
-			// Turn off LED on PA0
-			GPIO_SetBits(GPIOA, GPIO_Pin_0);
+			__WFI();
 		}
+		__enable_irq();
 	}
 }
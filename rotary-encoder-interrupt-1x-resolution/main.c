@@ -1,10 +1,10 @@
 #include "stm32f10x.h"
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
-#include "stm32f10x_exti.h"
 #include "delay.h"
 #include "lcd16x2.h"
-#include <stdio.h>
+#include "qdec.h"
+#include "fmt.h"
 
 // LCD custom char
 uint8_t bar[][8] = 
@@ -16,24 +16,13 @@ uint8_t bar[][8] =
 	{ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E },
 	{ 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }
 };
-volatile int enc_cnt;
-char enc_cnt_buf[4];
+qdec_snapshot_t enc;
+int enc_cnt;
+char enc_cnt_buf[17];
 
 void init_lcd(void);
 void init_rotary_encoder(void);
 void lcd_update(void);
-void rotary_encoder_update(void);
-
-void EXTI9_5_IRQHandler(void)
-{	
-	if (EXTI_GetITStatus(EXTI_Line6))
-	{
-		rotary_encoder_update();
-		
-		// Clear interrupt flag
-		EXTI_ClearITPendingBit(EXTI_Line6);
-	}
-}
 
 int main(void)
 {
@@ -63,43 +52,30 @@ void init_lcd()
 
 void init_rotary_encoder()
 {
-	GPIO_InitTypeDef GPIO_InitStruct;
-	EXTI_InitTypeDef EXTI_InitStruct;
-	NVIC_InitTypeDef NVIC_InitStruct;
-	
-	// Step 1: Initialize GPIO as input for rotary encoder
-	// PB6 (encoder pin A), PB5 (encoder pin B)
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_6 | GPIO_Pin_5;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(GPIOB, &GPIO_InitStruct);
-	
-	// Step 2: Initialize EXTI for PB6
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
-	GPIO_EXTILineConfig(GPIO_PortSourceGPIOB, GPIO_PinSource6);
-	EXTI_InitStruct.EXTI_Line = EXTI_Line6;
-	EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
-	EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Falling;
-	EXTI_InitStruct.EXTI_LineCmd = ENABLE;
-	EXTI_Init(&EXTI_InitStruct);
-	
-	// Step 3: Initialize NVIC for EXTI9_5 IRQ channel
-	NVIC_InitStruct.NVIC_IRQChannel = EXTI9_5_IRQn;
-	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 0x00;
-	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0x00;
-	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
-	NVIC_Init(&NVIC_InitStruct);
+	// Set System Timer IRQ at higher priority than encoder IRQ
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
+	// PB6 (encoder pin A), PB5 (encoder pin B), 4 counts per step
+	qdec_init(0, 80 * 4);
 }
 
 void lcd_update()
 {
 	uint8_t div_bar, mod_bar;
-	uint8_t i;
+	uint8_t i, n;
 	
+	// Position, velocity and error count of the same moment
+	qdec_get(&enc);
+	enc_cnt = enc.position / 4;
 	div_bar = enc_cnt / 5;
 	mod_bar = enc_cnt % 5;
-	sprintf(enc_cnt_buf, "%i", enc_cnt);
+	// "cnt vel/s eN": count left aligned, error count limited to 3 digits
+	n = fmt_int(enc_cnt_buf, enc_cnt, 0, FMT_PAD_SPACE);
+	n += fmt_fill(&enc_cnt_buf[n], ' ', (n < 3) ? (4 - n) : 1);
+	n += fmt_int(&enc_cnt_buf[n], enc.velocity / 1024, 5, FMT_PAD_SPACE);
+	n += fmt_str(&enc_cnt_buf[n], "/s e", 0);
+	n += fmt_dec(&enc_cnt_buf[n], enc.illegal, 3, FMT_PAD_SPACE);
+	enc_cnt_buf[n] = '\0';
 	
 	lcd16x2_clrscr();
 	for (i = 0; i < div_bar; i++)
@@ -110,29 +86,6 @@ void lcd_update()
 	lcd16x2_gotoxy(0, 1);
 	lcd16x2_puts(enc_cnt_buf);
 	
-	DelayMs(250);
-}
-
-void rotary_encoder_update()
-{
-	// When falling edge interrupt triggered by pin A of rotary encoder, 
-	// then read pin B of rotary encoder (1x resolution)
-	if ((GPIOB->IDR & GPIO_Pin_5))
-	{
-		enc_cnt++;
-	}
-	else
-	{
-		enc_cnt--;
-	}
-	
-	// Set max and min value
-	if (enc_cnt > 80)
-	{
-		enc_cnt = 80;
-	}
-	if (enc_cnt < 0)
-	{
-		enc_cnt = 0;
-	}
+	// Sleep between LCD updates, encoder interrupts still wake the core
+	DelaySleepMs(250);
 }
@@ -0,0 +1,185 @@
+/**
+  ******************************************************************************
+  * @file		qdec.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "qdec.h"
+
+/** Private defines --------------------------------------------------------- */
+#define QDEC_EXTI_LINES		((1 << QDEC_PIN_A) | (1 << QDEC_PIN_B))
+// Table entry for a transition with both pins changed
+#define QDEC_ILLEGAL			2
+
+/** Private variables ------------------------------------------------------- */
+// Step by (previous state << 2) | current state, state is (A << 1) | B.
+// Forward sequence is 00 -> 10 -> 11 -> 01 -> 00.
+static const int8_t qdecTable[16] = 
+{
+	 0, -1,  1,  QDEC_ILLEGAL,
+	 1,  0,  QDEC_ILLEGAL, -1,
+	-1,  QDEC_ILLEGAL,  0,  1,
+	 QDEC_ILLEGAL,  1, -1,  0
+};
+static int32_t posMin;
+static int32_t posMax;
+static uint8_t lastState;
+static __IO int8_t lastStep;
+// Valid edges in a row in the same direction (up to 4)
+static uint8_t run;
+// Times of the last 4 valid edges, a full quadrature cycle
+static __IO uint32_t edgeTimes[4];
+// Decoder state read by qdec_get(), seq changes after every update
+static __IO int32_t position;
+static __IO uint32_t edges;
+static __IO uint32_t illegal;
+static __IO uint32_t interval;
+static __IO uint8_t intervalEdges;
+static __IO uint32_t seq;
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize encoder pins and EXTI on both edges of both pins
+  * @param	Min position
+  * @param	Max position
+  * @retval	None
+  ******************************************************************************
+  */
+void qdec_init(int32_t min, int32_t max)
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	EXTI_InitTypeDef EXTI_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	uint32_t idr;
+
+	posMin = min;
+	posMax = max;
+	position = min;
+
+	// Step 1: Initialize GPIO as input for rotary encoder
+	RCC_APB2PeriphClockCmd(QDEC_RCC_GPIO, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = (1 << QDEC_PIN_A) | (1 << QDEC_PIN_B);
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_Init(QDEC_GPIO, &GPIO_InitStruct);
+	idr = QDEC_GPIO->IDR;
+	lastState = (((idr >> QDEC_PIN_A) & 1) << 1) | ((idr >> QDEC_PIN_B) & 1);
+
+	// Step 2: Initialize EXTI for both pins
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+	GPIO_EXTILineConfig(QDEC_PORTSRC, QDEC_PIN_A);
+	GPIO_EXTILineConfig(QDEC_PORTSRC, QDEC_PIN_B);
+	EXTI_InitStruct.EXTI_Line = QDEC_EXTI_LINES;
+	EXTI_InitStruct.EXTI_Mode = EXTI_Mode_Interrupt;
+	EXTI_InitStruct.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+	EXTI_InitStruct.EXTI_LineCmd = ENABLE;
+	EXTI_Init(&EXTI_InitStruct);
+
+	// Step 3: Initialize NVIC, lower priority than SysTick
+	NVIC_InitStruct.NVIC_IRQChannel = QDEC_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Take a consistent snapshot of the decoder without blocking the
+  *					interrupt, and estimate velocity from the edge interval. The
+  *					interval is over a full cycle (4 edges) once 4 edges in a row
+  *					went the same way, so uneven phase of A and B cancels out.
+  * @param	Pointer to snapshot destination
+  * @retval	None
+  ******************************************************************************
+  */
+void qdec_get(qdec_snapshot_t* snapshot)
+{
+	uint32_t start, span, elapsed;
+	uint8_t count;
+	int8_t dir;
+
+	// Copy again if an edge was decoded while copying
+	do
+	{
+		start = seq;
+		snapshot->position = position;
+		snapshot->edges = edges;
+		snapshot->illegal = illegal;
+		snapshot->edge_time = edgeTimes[(edges - 1) & 3];
+		span = interval;
+		count = intervalEdges;
+		dir = lastStep;
+	} while (start != seq);
+
+	// Slower than the last interval since no edge came, use the time
+	// since the last edge as the upper bound
+	elapsed = DelayGetCycles() - snapshot->edge_time;
+	if (elapsed > span)
+	{
+		span = elapsed;
+		count = 1;
+	}
+
+	snapshot->velocity = 0;
+	if ((snapshot->edges > 1) && (span != 0) &&
+		(elapsed < (SystemCoreClock / 1000) * QDEC_STOP_MS))
+	{
+		snapshot->velocity = (int32_t)(((uint64_t)SystemCoreClock * count << 8) / 
+			span) * dir;
+	}
+}
+
+void QDEC_IRQHandler()
+{
+	uint32_t now = DelayGetCycles();
+	uint32_t idr;
+	uint8_t state;
+	int8_t step;
+
+	// Clear first, an edge while decoding raises the interrupt again
+	EXTI->PR = QDEC_EXTI_LINES;
+	idr = QDEC_GPIO->IDR;
+	state = (((idr >> QDEC_PIN_A) & 1) << 1) | ((idr >> QDEC_PIN_B) & 1);
+	step = qdecTable[(lastState << 2) | state];
+	lastState = state;
+
+	if (step == 0)
+	{
+		// Pin went back before the interrupt ran
+		return;
+	}
+	if (step == QDEC_ILLEGAL)
+	{
+		illegal++;
+		run = 0;
+		seq++;
+		return;
+	}
+
+	position += step;
+	if (position > posMax)
+	{
+		position = posMax;
+	}
+	if (position < posMin)
+	{
+		position = posMin;
+	}
+
+	// Interval over the last full cycle, or the last edge after a reversal
+	run = (step == lastStep) ? run + (run < 4) : 1;
+	lastStep = step;
+	intervalEdges = (run == 4) ? 4 : 1;
+	interval = now - edgeTimes[(edges - intervalEdges) & 3];
+	edgeTimes[edges & 3] = now;
+	edges++;
+	seq++;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
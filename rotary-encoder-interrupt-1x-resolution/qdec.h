@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file		qdec.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Quadrature decoder on EXTI (both edges of pin A and pin B, 4x
+	*					resolution). Each edge is decoded by a 16-entry table indexed
+	*					by the previous and current pin state. Transitions where both
+	*					pins changed (missed edge or bounce) are counted as illegal and
+	*					do not move the position. Edges are timestamped with the DWT
+	*					cycle counter for velocity estimation. DelayInit() must be
+	*					called first.
+  ******************************************************************************
+  */
+
+#ifndef __QDEC_H
+#define __QDEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_exti.h"
+#include "misc.h"
+#include "delay.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Encoder pins (same GPIO), EXTI lines and IRQ
+#define QDEC_RCC_GPIO				RCC_APB2Periph_GPIOB
+#define QDEC_GPIO						GPIOB
+#define QDEC_PORTSRC				GPIO_PortSourceGPIOB
+#define QDEC_PIN_A					6
+#define QDEC_PIN_B					5
+#define QDEC_IRQn						EXTI9_5_IRQn
+#define QDEC_IRQHandler			EXTI9_5_IRQHandler
+
+// Velocity is 0 when no edge came for this long
+#define QDEC_STOP_MS				500
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	int32_t position;						// Counts, limited to the init range
+	uint32_t edges;							// Valid edges
+	uint32_t illegal;						// Transitions with both pins changed
+	uint32_t edge_time;					// DelayGetCycles() at the last valid edge
+	int32_t velocity;						// Counts per second, Q8 fixed point
+} qdec_snapshot_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void qdec_init(int32_t min, int32_t max);
+void qdec_get(qdec_snapshot_t* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
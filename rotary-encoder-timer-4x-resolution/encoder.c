@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @file		encoder.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "encoder.h"
+
+/** Private typedefs -------------------------------------------------------- */
+typedef struct
+{
+	int64_t countBase;
+	uint16_t countLast;
+	int32_t velocity;
+	int32_t acceleration;
+	uint32_t time;
+} encoder_sample_t;
+
+/** Private variables ------------------------------------------------------- */
+// Count at the last sample and the 16-bit counter value it was taken from
+static int64_t countBase;
+static uint16_t countLast;
+// Upper 16 bits of the timebase and its last counter value
+static uint16_t timeHigh;
+static uint16_t timeLast;
+// Last latched edge: encoder count (16 bits is enough for differences)
+// and timebase us, and the time between the last two edges
+static uint16_t edgeCount;
+static uint32_t edgeTime;
+static uint32_t edgePeriod;
+static uint8_t edgeValid;
+static int32_t velocity;
+static int32_t acceleration;
+// Results of the last sample are published to one buffer while readers
+// copy the other, seq changes after every update
+static __IO encoder_sample_t samples[2];
+static __IO uint8_t sampleIndex;
+static __IO uint32_t seq;
+
+/** Private function prototypes --------------------------------------------- */
+static void encoder_sample(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize encoder pins, TIM4 encoder mode, and the TIM3
+  *					timebase for edge times, sampling and count extension
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void encoder_init()
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStruct;
+	TIM_ICInitTypeDef TIM_ICInitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	
+	// Step 1: Initialize GPIO as input for rotary encoder
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_7 | GPIO_Pin_6;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_Init(GPIOB, &GPIO_InitStruct);
+	
+	// Step 2: Setup TIM4 for encoder input over the full 16-bit range.
+	// Capture the count on channel 1 edges and pulse TRGO on each capture.
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+	TIM_SetAutoreload(ENCODER_TIM, 0xFFFF);
+	TIM_EncoderInterfaceConfig(ENCODER_TIM, TIM_EncoderMode_TI12, 
+		TIM_ICPolarity_Rising, TIM_ICPolarity_Falling);
+	TIM_CCxCmd(ENCODER_TIM, TIM_Channel_1, TIM_CCx_Enable);
+	TIM_SelectOutputTrigger(ENCODER_TIM, TIM_TRGOSource_OC1);
+	
+	// Step 3: Setup TIM3 as free running 1 MHz timebase (APB1 timer clock
+	// is the core clock with APB1 prescaler 2). Channel 1 captures the
+	// time of the TIM4 trigger, channel 2 compare runs the sampling.
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+	TIM_TimeBaseInitStruct.TIM_Prescaler = (SystemCoreClock / 1000000) - 1;
+	TIM_TimeBaseInitStruct.TIM_Period = 0xFFFF;
+	TIM_TimeBaseInitStruct.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStruct.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInit(ENCODER_TIMEBASE, &TIM_TimeBaseInitStruct);
+	TIM_SelectInputTrigger(ENCODER_TIMEBASE, TIM_TS_ITR3);
+	TIM_ICInitStruct.TIM_Channel = TIM_Channel_1;
+	TIM_ICInitStruct.TIM_ICPolarity = TIM_ICPolarity_Rising;
+	TIM_ICInitStruct.TIM_ICSelection = TIM_ICSelection_TRC;
+	TIM_ICInitStruct.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+	TIM_ICInitStruct.TIM_ICFilter = 0;
+	TIM_ICInit(ENCODER_TIMEBASE, &TIM_ICInitStruct);
+	TIM_SetCompare2(ENCODER_TIMEBASE, ENCODER_SAMPLE_US);
+	TIM_ClearITPendingBit(ENCODER_TIMEBASE, TIM_IT_CC2);
+	TIM_ITConfig(ENCODER_TIMEBASE, TIM_IT_CC2, ENABLE);
+	
+	// Step 4: Initialize NVIC, sampling at lower priority than SysTick
+	NVIC_InitStruct.NVIC_IRQChannel = ENCODER_TIMEBASE_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+	
+	countBase = 0;
+	countLast = ENCODER_TIM->CNT;
+	samples[0].countLast = countLast;
+	TIM_Cmd(ENCODER_TIM, ENABLE);
+	TIM_Cmd(ENCODER_TIMEBASE, ENABLE);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the encoder count, wraps around at 32 bits
+  * @param	None
+  * @retval	Counts
+  ******************************************************************************
+  */
+int32_t encoder_get_count()
+{
+	return (int32_t)encoder_get_count64();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the 64-bit encoder count without locking. Safe from any
+  *					context, also when the sample interrupt is pending and cannot
+  *					run yet.
+  * @param	None
+  * @retval	Counts
+  ******************************************************************************
+  */
+int64_t encoder_get_count64()
+{
+	__IO encoder_sample_t* sample;
+	uint32_t start;
+	int64_t count;
+	
+	// Base and counter must belong to the same sample, copy again if a
+	// sample was taken while copying
+	do
+	{
+		start = seq;
+		sample = &samples[sampleIndex];
+		count = sample->countBase + 
+			(int16_t)(ENCODER_TIM->CNT - sample->countLast);
+	} while (start != seq);
+	
+	return count;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get position, velocity and acceleration without locking, fast
+  *					enough to be called from a control loop at kHz rates
+  * @param	Pointer to snapshot destination
+  * @retval	None
+  ******************************************************************************
+  */
+void encoder_get(encoder_snapshot_t* snapshot)
+{
+	__IO encoder_sample_t* sample;
+	uint32_t start;
+	
+	// Position is extended from the same sample as velocity and
+	// acceleration. Copy again if a sample was taken while copying.
+	do
+	{
+		start = seq;
+		sample = &samples[sampleIndex];
+		snapshot->position = sample->countBase + 
+			(int16_t)(ENCODER_TIM->CNT - sample->countLast);
+		snapshot->velocity = sample->velocity;
+		snapshot->acceleration = sample->acceleration;
+		snapshot->time = sample->time;
+	} while (start != seq);
+}
+
+void ENCODER_TIMEBASE_IRQHandler()
+{
+	if (ENCODER_TIMEBASE->SR & TIM_SR_CC2IF)
+	{
+		ENCODER_TIMEBASE->SR = ~TIM_SR_CC2IF;
+		ENCODER_TIMEBASE->CCR2 += ENCODER_SAMPLE_US;
+		encoder_sample();
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Extend the count, update velocity and acceleration from the
+  *					latched edges
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void encoder_sample()
+{
+	__IO encoder_sample_t* sample;
+	uint16_t now16, edgeTime16, count16, cnt;
+	uint32_t now, time, elapsed;
+	int16_t counts;
+	int32_t speed = velocity;
+	int32_t accel;
+	
+	// Extend the count by the signed change since the last sample. It is
+	// correct in both directions and across any number of wraps back and
+	// forth, as long as the encoder moves less than 32768 counts per sample.
+	cnt = ENCODER_TIM->CNT;
+	countBase += (int16_t)(cnt - countLast);
+	countLast = cnt;
+	
+	// Extend the timebase, samples come much faster than it wraps
+	now16 = ENCODER_TIMEBASE->CNT;
+	if (now16 < timeLast)
+	{
+		timeHigh++;
+	}
+	timeLast = now16;
+	now = ((uint32_t)timeHigh << 16) | now16;
+	
+	if (ENCODER_TIMEBASE->SR & TIM_SR_CC1IF)
+	{
+		// New edge since the last sample. Reading CCR1 clears the flag, it
+		// is set again if another edge latched a new pair meanwhile.
+		do
+		{
+			edgeTime16 = ENCODER_TIMEBASE->CCR1;
+			count16 = ENCODER_TIM->CCR1;
+		} while (ENCODER_TIMEBASE->SR & TIM_SR_CC1IF);
+		time = now - (uint16_t)(now16 - edgeTime16);
+		
+		// M/T: counts between the last two edges over their exact distance
+		if (edgeValid)
+		{
+			counts = (int16_t)(count16 - edgeCount);
+			edgePeriod = time - edgeTime;
+			speed = edgePeriod ? 
+				(int32_t)(((int64_t)counts * 1000000 * 256) / edgePeriod) : 0;
+		}
+		edgeCount = count16;
+		edgeTime = time;
+		edgeValid = 1;
+	}
+	else if (edgeValid)
+	{
+		// No edge: when it is overdue, the speed is at most one cycle over
+		// the time since the last edge, and stopped after a while
+		elapsed = now - edgeTime;
+		if (elapsed >= ENCODER_STOP_US)
+		{
+			speed = 0;
+		}
+		else if ((elapsed > edgePeriod) && (speed != 0))
+		{
+			speed = (int32_t)((ENCODER_EDGE_COUNTS * 1000000LL * 256) / elapsed);
+			if (velocity < 0)
+			{
+				speed = -speed;
+			}
+		}
+	}
+	
+	// Acceleration from the velocity change (Q8 to integer), low-pass filtered
+	accel = (int32_t)(((int64_t)(speed - velocity) * 
+		(1000000 / ENCODER_SAMPLE_US)) / 256);
+	accel = acceleration + ((accel - acceleration) / (1 << ENCODER_ACC_SHIFT));
+	
+	velocity = speed;
+	acceleration = accel;
+	
+	// Fill the buffer readers do not use, then switch to it. A reader that
+	// interrupts this keeps copying a complete sample, a reader interrupted
+	// by this sees seq change and copies again.
+	sample = &samples[sampleIndex ^ 1];
+	sample->countBase = countBase;
+	sample->countLast = countLast;
+	sample->velocity = speed;
+	sample->acceleration = accel;
+	sample->time = now;
+	sampleIndex ^= 1;
+	seq++;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file		encoder.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Quadrature encoder on TIM4 (encoder mode, 4x resolution). The
+	*					16-bit counter is extended to 64 bits from its signed change
+	*					in every sample (ENCODER_SAMPLE_US), so wraps need no interrupt
+	*					and jitter around a wrap cannot be miscounted. Velocity uses
+	*					the M/T method: every encoder edge on channel 1 latches the
+	*					TIM4 count and, through TRGO, a 1 MHz TIM3 timestamp. Each
+	*					sample divides the counts between the last two latched edges
+	*					by their time difference, so it is exact at high speed (many
+	*					edges per sample) and at low speed (edge period longer than a
+	*					sample) alike.
+  ******************************************************************************
+  */
+
+#ifndef __ENCODER_H
+#define __ENCODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_tim.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Encoder timer, PB7 (TIM4_CH2) encoder pin A, PB6 (TIM4_CH1) encoder pin B
+#define ENCODER_TIM							TIM4
+// 1 MHz timebase, captures edge times (ITR3 is TIM4) and runs the sampling
+#define ENCODER_TIMEBASE				TIM3
+#define ENCODER_TIMEBASE_IRQn		TIM3_IRQn
+#define ENCODER_TIMEBASE_IRQHandler	TIM3_IRQHandler
+
+// Velocity sample period in us
+#define ENCODER_SAMPLE_US				1000
+// Velocity is 0 when no edge came for this long
+#define ENCODER_STOP_US					500000
+// Counts between two latched edges of the same direction (1 cycle)
+#define ENCODER_EDGE_COUNTS			4
+// Acceleration low-pass filter, new = old + (raw - old) / 2^shift
+#define ENCODER_ACC_SHIFT				3
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	int64_t position;								// Counts at the time of the call
+	int32_t velocity;								// Counts per second, Q8 fixed point
+	int32_t acceleration;						// Counts per second^2, filtered
+	uint32_t time;									// Timebase us of the last sample
+} encoder_snapshot_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void encoder_init(void);
+int32_t encoder_get_count(void);
+int64_t encoder_get_count64(void);
+void encoder_get(encoder_snapshot_t* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -4,10 +4,11 @@
 #include "stm32f10x_tim.h"
 #include "delay.h"
 #include "lcd16x2.h"
-#include <stdio.h>
+#include "encoder.h"
+#include "fmt.h"
 
-uint16_t enc_cnt;
-char enc_cnt_buf[8];
+encoder_snapshot_t enc;
+char enc_cnt_buf[17];
 
 void init_lcd(void);
 void init_rotary_encoder(void);
@@ -33,32 +34,31 @@ void init_lcd()
 
 void init_rotary_encoder()
 {
-	GPIO_InitTypeDef GPIO_InitStruct;
-	
-	// Step 1: Initialize GPIO as input for rotary encoder
+	// Set System Timer IRQ at higher priority than encoder IRQs
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
 	// PB7 (TIM4_CH2) (encoder pin A), PB6 (TIM4_CH1) (encoder pin B)
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_7 | GPIO_Pin_6;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(GPIOB, &GPIO_InitStruct);
-	
-	// Step 2: Setup TIM4 for encoder input
-	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
-	TIM_EncoderInterfaceConfig(TIM4, TIM_EncoderMode_TI12, TIM_ICPolarity_Rising, 
-		TIM_ICPolarity_Falling);
-	TIM_Cmd(TIM4, ENABLE);
+	encoder_init();
 }
 
 void lcd_update()
 {
-	// Get encoder value
-	enc_cnt = TIM_GetCounter(TIM4);
+	uint8_t n;
 	
-	// Print encoder value
-	sprintf(enc_cnt_buf, "%i", enc_cnt);
+	// Get encoder position, velocity and acceleration
+	encoder_get(&enc);
+	
+	// Print position (32-bit), velocity and acceleration
 	lcd16x2_clrscr();
+	n = fmt_int(enc_cnt_buf, (int32_t)enc.position, 0, FMT_PAD_SPACE);
+	enc_cnt_buf[n] = '\0';
+	lcd16x2_puts(enc_cnt_buf);
+	n = fmt_fixed(enc_cnt_buf, enc.velocity, 8, 1, 8);
+	n += fmt_int(&enc_cnt_buf[n], enc.acceleration, 8, FMT_PAD_SPACE);
+	enc_cnt_buf[n] = '\0';
+	lcd16x2_gotoxy(0, 1);
 	lcd16x2_puts(enc_cnt_buf);
 	
-	DelayMs(250);
+	// Sleep between LCD updates, encoder interrupts still wake the core
+	DelaySleepMs(250);
 }
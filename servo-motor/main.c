@@ -4,6 +4,7 @@
 #include "stm32f10x_tim.h"
 #include "delay.h"
 #include "lcd16x2.h"
+#include "swtimer.h"
 
 #define DEGREE_0			0
 #define DEGREE_45			45
@@ -13,6 +14,16 @@
 
 void PWM_Init(void);
 void displayServoPosition(int degree);
+void nextServoPosition(void* arg);
+
+// Servo positions and their PWM compare values, stepped every 2 s
+#define SERVO_POSITIONS	5
+const int servoDegree[SERVO_POSITIONS] = 
+{
+	DEGREE_0, DEGREE_45, DEGREE_90, DEGREE_135, DEGREE_180
+};
+const uint16_t servoPulse[SERVO_POSITIONS] = { 520, 840, 1140, 1500, 1800 };
+swtimer_t servoTimer;
 
 int main(void)
 {
@@ -22,28 +33,31 @@ int main(void)
 	// Initialize PWM
 	PWM_Init();
 	
+	// Step servo position every 2 s
+	swtimer_init();
+	swtimer_create(&servoTimer, nextServoPosition, 0);
+	swtimer_start(&servoTimer, 0, 2000);
+	
 	while (1)
 	{
-		// Set servo position to 0 degree
-		displayServoPosition(DEGREE_0);
-		TIM2->CCR1 = 520;
-		DelayMs(2000);
-		// Set servo position to 45 degree
-		displayServoPosition(DEGREE_45);
-		TIM2->CCR1 = 840;
-		DelayMs(2000);
-		// Set servo position to 90 degree
-		displayServoPosition(DEGREE_90);
-		TIM2->CCR1 = 1140;
-		DelayMs(2000);
-		// Set servo position to 135 degree
-		displayServoPosition(DEGREE_135);
-		TIM2->CCR1 = 1500;
-		DelayMs(2000);
-		// Set servo position to 180 degree
-		displayServoPosition(DEGREE_180);
-		TIM2->CCR1 = 1800;
-		DelayMs(2000);
+		swtimer_process();
+		// Sleep until the next timer is due or an interrupt occurs
+		DelayIdle(swtimer_idle_ms());
+	}
+}
+
+void nextServoPosition(void* arg)
+{
+	static uint8_t index = 0;
+	
+	// Set servo position
+	displayServoPosition(servoDegree[index]);
+	TIM2->CCR1 = servoPulse[index];
+	
+	index++;
+	if (index >= SERVO_POSITIONS)
+	{
+		index = 0;
 	}
 }
 
@@ -2,11 +2,10 @@
 #include "stm32f10x_rcc.h"
 #include "stm32f10x_gpio.h"
 #include "delay.h"
-
-static __inline void debounce(void);
+#include "button.h"
 
 GPIO_InitTypeDef GPIO_InitStruct;
-volatile uint8_t button_pressed = 0;
+button_event_t event;
 
 int main(void)
 {
@@ -14,63 +13,38 @@ int main(void)
 	
 	// Enable clock for GPIOB
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-	// Initialize PB12 as input with pull-up resistor
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_12;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IPU;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(GPIOB, &GPIO_InitStruct);
 	// Initialize PB13 as push-pull output
 	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_13;
 	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
 	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
 	GPIO_Init(GPIOB, &GPIO_InitStruct);
 	
-	while (1)
-	{
-		// Update button_state
-		debounce();
-		// Check if the button is pressed
-		if (button_pressed)
-		{
-			// Clear flag
-			button_pressed = 0;
-			// Toggle LED on PB13
-			GPIOB->ODR ^= GPIO_Pin_13;
-		}
-		// Delay for a while so we don't check to button too often
-		DelayMs(10);
-	}
-}
-
-static __inline void debounce(void)
-{
-	// Counter for number of equal states
-	static uint8_t count = 0;
-	// Keep track of current (debounced) state
-	static uint8_t button_state = 0;
-
-	// Check if button is high or low for the moment
-	uint8_t current_state = (GPIOB->IDR & GPIO_Pin_12) == 0;
+	// Set System Timer IRQ at higher priority than button tick
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	NVIC_SetPriority(SysTick_IRQn, 0);
+	// Debounce PB12 (input with pull-up resistor, active low)
+	button_init(BUTTON_HI(GPIO_Pin_12), BUTTON_HI(GPIO_Pin_12));
 	
-	if (current_state != button_state)
+	while (1)
 	{
-		// Button state is about to be changed, increase counter
-		count++;
-		if (count >= 4)
+		while (button_get_event(&event))
 		{
-			// The button have not bounced for four checks, change state
-			button_state = current_state;
-			// If the button was pressed (not released), tell main so
-			if (current_state != 0)
+			switch (event.type)
 			{
-				button_pressed = 1;
+				// Toggle LED on PB13 on every press, and keep blinking
+				// it while the button is held down
+				case BUTTON_EVENT_PRESS:
+				case BUTTON_EVENT_LONG:
+				case BUTTON_EVENT_REPEAT:
+					GPIOB->ODR ^= GPIO_Pin_13;
+					break;
+				// Double click turns LED off
+				case BUTTON_EVENT_DOUBLE:
+					GPIOB->BRR = GPIO_Pin_13;
+					break;
 			}
-			count = 0;
 		}
-	}
-	else
-	{
-		// Reset counter
-		count = 0;
+		// Sleep until the next button tick
+		DelayIdleUntil(button_event_pending, DELAY_IDLE_FOREVER);
 	}
 }
@@ -4,118 +4,67 @@
 #include "stm32f10x_spi.h"
 #include "delay.h"
 #include "lcd16x2.h"
+#include "spi_dma.h"
+#include "fmt.h"
 
-#define SPIx_RCC				RCC_APB2Periph_SPI1
-#define SPIx						SPI1
-#define SPI_GPIO_RCC		RCC_APB2Periph_GPIOA
-#define SPI_GPIO				GPIOA
-#define SPI_PIN_MOSI		GPIO_Pin_7
-#define SPI_PIN_MISO		GPIO_Pin_6
-#define SPI_PIN_SCK			GPIO_Pin_5
-#define SPI_PIN_SS			GPIO_Pin_4
+// Bytes moved by each path of the throughput test
+#define BENCH_LEN				256
 
-void SPIx_Init(void);
 uint8_t SPIx_Transfer(uint8_t data);
-void SPIx_EnableSlave(void);
-void SPIx_DisableSlave(void);
-	
+uint8_t SPIx_Command(uint8_t command);
+uint32_t SPIx_Benchmark(uint8_t dma);
+void SPIx_TransferDone(void);
+uint8_t SPIx_TransferFinished(void);
+void LCD_PrintRate(const char* label, uint32_t cycles);
+void LCD_PrintStatus(uint8_t command, uint8_t status);
+
 uint8_t receivedByte;
+uint8_t benchTx[BENCH_LEN];
+uint8_t benchRx[BENCH_LEN];
+// Cycles taken by BENCH_LEN bytes, byte-wise and with DMA
+uint32_t pollCycles;
+uint32_t dmaCycles;
+__IO uint8_t transferDone;
 
 int main(void)
 {
+	uint16_t i;
+	
 	DelayInit();
 	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
 	
-	SPIx_Init();
+	// Throughput at 18 MHz, the fastest clock SPI1 supports
+	spi_init(SPI_BaudRatePrescaler_4, SPI_FRAME_8BIT);
+	for (i = 0; i < BENCH_LEN; i++)
+	{
+		benchTx[i] = i;
+	}
+	pollCycles = SPIx_Benchmark(0);
+	dmaCycles = SPIx_Benchmark(1);
+	lcd16x2_clrscr();
+	LCD_PrintRate("Poll", pollCycles);
+	lcd16x2_gotoxy(0, 1);
+	LCD_PrintRate("DMA ", dmaCycles);
+	DelayMs(2500);
+	
+	// Slave commands at the original slow clock
+	spi_set_prescaler(SPI_BaudRatePrescaler_128);
 	
 	while (1)
 	{
-		// Enable slave
-		SPIx_EnableSlave();
-		// Write command to slave to turn on LED blinking
-		SPIx_Transfer((uint8_t) '1');
-		DelayUs(10);
-		// Write command to slave for asking LED blinking status
-		SPIx_Transfer((uint8_t) '?');
-		DelayUs(10);
-		// Read LED blinking status (off/on) from slave by transmitting dummy byte
-		receivedByte = SPIx_Transfer(0);
-		// Disable slave
-		SPIx_DisableSlave();
-		// Display LED blinking status
-		lcd16x2_clrscr();
-		if (receivedByte == 0)
-		{
-			lcd16x2_puts("LED Blinking Off");
-		}
-		else if (receivedByte == 1)
-		{
-			lcd16x2_puts("LED Blinking On");
-		}
-		DelayMs(2500);
+		// Turn on LED blinking, the reply is the status left by the '0'
+		// command of the previous round
+		receivedByte = SPIx_Command((uint8_t) '1');
+		LCD_PrintStatus('1', receivedByte);
+		DelaySleepMs(2500);
 		
-		// Enable slave
-		SPIx_EnableSlave();
-		// Write command to slave to turn off LED blinking
-		SPIx_Transfer((uint8_t) '0');
-		DelayUs(10);
-		// Write command to slave for asking LED blinking status
-		SPIx_Transfer((uint8_t) '?');
-		DelayUs(10);
-		// Read LED blinking status (off/on) from slave by transmitting dummy byte
-		receivedByte = SPIx_Transfer(0);
-		// Disable slave
-		SPIx_DisableSlave();
-		// Display LED blinking status
-		lcd16x2_clrscr();
-		if (receivedByte == 0)
-		{
-			lcd16x2_puts("LED Blinking Off");
-		}
-		else if (receivedByte == 1)
-		{
-			lcd16x2_puts("LED Blinking On");
-		}
-		DelayMs(2500);
+		// Turn off LED blinking, the reply confirms the '1' command
+		receivedByte = SPIx_Command((uint8_t) '0');
+		LCD_PrintStatus('0', receivedByte);
+		DelaySleepMs(2500);
 	}
 }
 
-void SPIx_Init()
-{
-	// Initialization struct
-	SPI_InitTypeDef SPI_InitStruct;
-	GPIO_InitTypeDef GPIO_InitStruct;
-	
-	// Step 1: Initialize SPI
-	RCC_APB2PeriphClockCmd(SPIx_RCC, ENABLE);
-	SPI_InitStruct.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_128;
-	SPI_InitStruct.SPI_CPHA = SPI_CPHA_1Edge;
-	SPI_InitStruct.SPI_CPOL = SPI_CPOL_Low;
-	SPI_InitStruct.SPI_DataSize = SPI_DataSize_8b;
-	SPI_InitStruct.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
-	SPI_InitStruct.SPI_FirstBit = SPI_FirstBit_MSB;
-	SPI_InitStruct.SPI_Mode = SPI_Mode_Master;
-	SPI_InitStruct.SPI_NSS = SPI_NSS_Soft | SPI_NSSInternalSoft_Set;
-	SPI_Init(SPIx, &SPI_InitStruct); 
-	SPI_Cmd(SPIx, ENABLE);
-	
-	// Step 2: Initialize GPIO
-	RCC_APB2PeriphClockCmd(SPI_GPIO_RCC, ENABLE);
-	// GPIO pins for MOSI, MISO, and SCK
-	GPIO_InitStruct.GPIO_Pin = SPI_PIN_MOSI | SPI_PIN_MISO | SPI_PIN_SCK;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
-	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
-	// GPIO pin for SS
-	GPIO_InitStruct.GPIO_Pin = SPI_PIN_SS;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
-	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
-	
-	// Disable SPI slave device
-	SPIx_DisableSlave();
-}
-
 uint8_t SPIx_Transfer(uint8_t data)
 {
 	// Write data to be transmitted to the SPI data register
@@ -130,14 +79,96 @@ uint8_t SPIx_Transfer(uint8_t data)
 	return SPIx->DR;
 }
 
-void SPIx_EnableSlave()
+uint8_t SPIx_Command(uint8_t command)
+{
+	// Command, then a dummy byte that clocks in the status. DMA sends the
+	// bytes back to back, so the slave answers with the response it staged
+	// before the frame started: the status as of the previous command.
+	uint8_t tx[2];
+	uint8_t rx[2];
+	
+	tx[0] = command;
+	tx[1] = 0;
+	transferDone = 0;
+	spi_transfer_async(tx, rx, sizeof(tx), SPIx_TransferDone);
+	// Sleep until the DMA interrupt ends the transfer
+	while (!transferDone)
+	{
+		DelayIdleUntil(SPIx_TransferFinished, DELAY_IDLE_FOREVER);
+	}
+	
+	return rx[1];
+}
+
+uint32_t SPIx_Benchmark(uint8_t dma)
 {
-	// Set slave SS pin low
-	SPI_GPIO->BRR = SPI_PIN_SS;
+	uint32_t start;
+	uint16_t i;
+	
+	start = DelayGetCycles();
+	if (dma)
+	{
+		spi_transfer_async(benchTx, benchRx, BENCH_LEN, 0);
+		while (spi_busy());
+	}
+	else
+	{
+		spi_select();
+		for (i = 0; i < BENCH_LEN; i++)
+		{
+			benchRx[i] = SPIx_Transfer(benchTx[i]);
+		}
+		spi_deselect();
+	}
+	
+	return DelayGetCycles() - start;
+}
+
+void SPIx_TransferDone()
+{
+	transferDone = 1;
+}
+
+uint8_t SPIx_TransferFinished()
+{
+	return transferDone;
 }
 
-void SPIx_DisableSlave()
+void LCD_PrintRate(const char* label, uint32_t cycles)
 {
-	// Set slave SS pin high
-	SPI_GPIO->BSRR = SPI_PIN_SS;
+	char line[16];
+	uint8_t n;
+	
+	// kB/s = bytes / (cycles / core clock) / 1000
+	n = fmt_str(line, label, 5);
+	n += fmt_dec(&line[n], (BENCH_LEN * (SystemCoreClock / 1000)) / cycles, 
+		5, FMT_PAD_SPACE);
+	n += fmt_str(&line[n], " kB/s", 5);
+	line[n] = '\0';
+	lcd16x2_puts(line);
+}
+
+void LCD_PrintStatus(uint8_t command, uint8_t status)
+{
+	// Display the LED blinking command just sent
+	lcd16x2_clrscr();
+	if (command == '1')
+	{
+		lcd16x2_puts("LED Blinking On");
+	}
+	else
+	{
+		lcd16x2_puts("LED Blinking Off");
+	}
+	
+	// Display the status the slave reported before the command
+	lcd16x2_gotoxy(0, 1);
+	if (status == 0)
+	{
+		lcd16x2_puts("Was Off");
+	}
+	else if (status == 1)
+	{
+		lcd16x2_puts("Was On");
+	}
 }
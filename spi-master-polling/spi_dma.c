@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file		spi_dma.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "spi_dma.h"
+
+/** Private variables ------------------------------------------------------- */
+static __IO uint8_t busy;
+static spi_callback_t callback;
+// Frame size bits of the DMA channels (PSIZE and MSIZE)
+static uint32_t dmaSize;
+// Sent when there is no tx buffer, written when there is no rx buffer
+static const uint16_t dummyTx = 0xFFFF;
+static uint16_t dummyRx;
+
+/** Private function prototypes --------------------------------------------- */
+static void spi_reconfigure(uint16_t mask, uint16_t value);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize SPI master with DMA
+  * @param	Clock prescaler (SPI_BaudRatePrescaler_2 to _256)
+  * @param	Frame size (SPI_FRAME_8BIT or SPI_FRAME_16BIT)
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_init(uint16_t prescaler, uint8_t frame)
+{
+	// Initialization struct
+	SPI_InitTypeDef SPI_InitStruct;
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	
+	// Step 1: Initialize SPI
+	RCC_APB2PeriphClockCmd(SPIx_RCC, ENABLE);
+	SPI_InitStruct.SPI_BaudRatePrescaler = prescaler;
+	SPI_InitStruct.SPI_CPHA = SPI_CPHA_1Edge;
+	SPI_InitStruct.SPI_CPOL = SPI_CPOL_Low;
+	SPI_InitStruct.SPI_DataSize = (frame == SPI_FRAME_16BIT) ? 
+		SPI_DataSize_16b : SPI_DataSize_8b;
+	SPI_InitStruct.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+	SPI_InitStruct.SPI_FirstBit = SPI_FirstBit_MSB;
+	SPI_InitStruct.SPI_Mode = SPI_Mode_Master;
+	SPI_InitStruct.SPI_NSS = SPI_NSS_Soft | SPI_NSSInternalSoft_Set;
+	SPI_Init(SPIx, &SPI_InitStruct);
+	dmaSize = (frame == SPI_FRAME_16BIT) ? 
+		(DMA_CCR1_PSIZE_0 | DMA_CCR1_MSIZE_0) : 0;
+	SPIx->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+	SPI_Cmd(SPIx, ENABLE);
+	
+	// Step 2: Initialize GPIO
+	RCC_APB2PeriphClockCmd(SPI_GPIO_RCC, ENABLE);
+	// GPIO pins for MOSI, MISO, and SCK
+	GPIO_InitStruct.GPIO_Pin = SPI_PIN_MOSI | SPI_PIN_MISO | SPI_PIN_SCK;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
+	// GPIO pin for SS
+	GPIO_InitStruct.GPIO_Pin = SPI_PIN_SS;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
+	spi_deselect();
+	
+	// Step 3: Fixed part of DMA setup, peripheral address is SPI data register.
+	// Only RX needs an interrupt, it completes after the last frame.
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	SPI_DMA_RX_CHANNEL->CCR = 0;
+	SPI_DMA_RX_CHANNEL->CPAR = (uint32_t) &SPIx->DR;
+	SPI_DMA_TX_CHANNEL->CCR = 0;
+	SPI_DMA_TX_CHANNEL->CPAR = (uint32_t) &SPIx->DR;
+	NVIC_InitStruct.NVIC_IRQChannel = SPI_DMA_RX_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Change SPI clock, waits for a running transfer to finish
+  * @param	Clock prescaler (SPI_BaudRatePrescaler_2 to _256)
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_set_prescaler(uint16_t prescaler)
+{
+	spi_reconfigure(SPI_CR1_BR, prescaler);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Change frame size, waits for a running transfer to finish
+  * @param	Frame size (SPI_FRAME_8BIT or SPI_FRAME_16BIT)
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_set_frame(uint8_t frame)
+{
+	if (frame == SPI_FRAME_16BIT)
+	{
+		spi_reconfigure(SPI_CR1_DFF, SPI_CR1_DFF);
+		dmaSize = DMA_CCR1_PSIZE_0 | DMA_CCR1_MSIZE_0;
+	}
+	else
+	{
+		spi_reconfigure(SPI_CR1_DFF, 0);
+		dmaSize = 0;
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start a full-duplex transfer. Chip select is asserted until the
+  *					last frame has been received.
+  * @param	Data to send, 0 to send 0xFF (0xFFFF) frames
+  * @param	Buffer for received data, 0 to discard it
+  * @param	Number of frames (bytes or 16-bit words), 1 to 65535
+  * @param	Function called when done, may be 0
+  * @retval	1 if started, 0 if a transfer is running or len is 0
+  ******************************************************************************
+  */
+uint8_t spi_transfer_async(const void* tx, void* rx, uint16_t len, 
+	spi_callback_t cb)
+{
+	if (busy || (len == 0))
+	{
+		return 0;
+	}
+	busy = 1;
+	callback = cb;
+	
+	// Discard stale data so the first DMA request is for this transfer
+	(void) SPIx->DR;
+	DMA1->IFCR = SPI_DMA_CLEAR;
+	
+	// RX has the higher priority so it is never overrun by TX
+	SPI_DMA_RX_CHANNEL->CMAR = rx ? (uint32_t) rx : (uint32_t) &dummyRx;
+	SPI_DMA_RX_CHANNEL->CNDTR = len;
+	SPI_DMA_RX_CHANNEL->CCR = dmaSize | DMA_CCR1_PL_1 | DMA_CCR1_TCIE | 
+		(rx ? DMA_CCR1_MINC : 0);
+	SPI_DMA_TX_CHANNEL->CMAR = tx ? (uint32_t) tx : (uint32_t) &dummyTx;
+	SPI_DMA_TX_CHANNEL->CNDTR = len;
+	SPI_DMA_TX_CHANNEL->CCR = dmaSize | DMA_CCR1_PL_0 | DMA_CCR1_DIR | 
+		(tx ? DMA_CCR1_MINC : 0);
+	
+	// TXE is already set, enabling TX channel starts the transfer
+	spi_select();
+	SPI_DMA_RX_CHANNEL->CCR |= DMA_CCR1_EN;
+	SPI_DMA_TX_CHANNEL->CCR |= DMA_CCR1_EN;
+	
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether a transfer is running
+  * @param	None
+  * @retval	1 if busy, otherwise 0
+  ******************************************************************************
+  */
+uint8_t spi_busy()
+{
+	return busy;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Assert chip select, for byte-wise access outside of transfers
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_select()
+{
+	// Set slave SS pin low
+	SPI_GPIO->BRR = SPI_PIN_SS;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Release chip select
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_deselect()
+{
+	// Set slave SS pin high
+	SPI_GPIO->BSRR = SPI_PIN_SS;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	DMA RX transfer complete handler, ends the transfer
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void SPI_DMA_RX_IRQHandler(void)
+{
+	if (DMA1->ISR & SPI_DMA_RX_TC_FLAG)
+	{
+		DMA1->IFCR = SPI_DMA_CLEAR;
+		SPI_DMA_RX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+		SPI_DMA_TX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+		
+		// Last frame is received, so the bus is already idle here
+		while (SPIx->SR & SPI_I2S_FLAG_BSY);
+		spi_deselect();
+		busy = 0;
+		
+		if (callback)
+		{
+			callback();
+		}
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Change CR1 bits that may only be written while SPI is disabled
+  * @param	Bits to change
+  * @param	New value of the bits
+  * @retval	None
+  ******************************************************************************
+  */
+static void spi_reconfigure(uint16_t mask, uint16_t value)
+{
+	while (busy);
+	
+	SPIx->CR1 &= ~SPI_CR1_SPE;
+	SPIx->CR1 = (SPIx->CR1 & ~mask) | value;
+	SPIx->CR1 |= SPI_CR1_SPE;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file		spi_dma.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		DMA driven full-duplex SPI master. A transfer runs in the
+	*					background with chip select asserted for its whole length,
+	*					the callback is called from the DMA interrupt after chip select
+	*					has been released.
+  ******************************************************************************
+  */
+
+#ifndef __SPI_DMA_H
+#define __SPI_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_spi.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define SPIx_RCC				RCC_APB2Periph_SPI1
+#define SPIx						SPI1
+#define SPI_GPIO_RCC		RCC_APB2Periph_GPIOA
+#define SPI_GPIO				GPIOA
+#define SPI_PIN_MOSI		GPIO_Pin_7
+#define SPI_PIN_MISO		GPIO_Pin_6
+#define SPI_PIN_SCK			GPIO_Pin_5
+#define SPI_PIN_SS			GPIO_Pin_4
+
+// DMA channels and IRQ for SPI1 (use channel 4/5 for SPI2)
+#define SPI_DMA_RX_CHANNEL		DMA1_Channel2
+#define SPI_DMA_TX_CHANNEL		DMA1_Channel3
+#define SPI_DMA_RX_TC_FLAG		DMA_ISR_TCIF2
+#define SPI_DMA_CLEAR					(DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3)
+#define SPI_DMA_RX_IRQn				DMA1_Channel2_IRQn
+#define SPI_DMA_RX_IRQHandler	DMA1_Channel2_IRQHandler
+
+// Frame size
+#define SPI_FRAME_8BIT		0
+#define SPI_FRAME_16BIT		1
+
+/** Typedefs ---------------------------------------------------------------- */
+// Called from interrupt when a transfer is done
+typedef void (*spi_callback_t)(void);
+
+/** Public function prototypes ---------------------------------------------- */
+void spi_init(uint16_t prescaler, uint8_t frame);
+void spi_set_prescaler(uint16_t prescaler);
+void spi_set_frame(uint8_t frame);
+uint8_t spi_transfer_async(const void* tx, void* rx, uint16_t len, 
+	spi_callback_t cb);
+uint8_t spi_busy(void);
+void spi_select(void);
+void spi_deselect(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
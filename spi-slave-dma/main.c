@@ -0,0 +1,113 @@
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "delay.h"
+#include "lcd16x2.h"
+#include "spi_slave.h"
+
+// Status byte position in the response, the master sends the command and
+// a dummy byte that clocks the status out. The response is staged before
+// the frame starts, so it holds the status as of the previous command.
+#define STATUS_INDEX		1
+
+#define LED_GPIO_RCC		RCC_APB2Periph_GPIOC
+#define LED_GPIO				GPIOC
+#define LED_PIN					GPIO_Pin_13
+
+void led_init(void);
+void status_stage(uint8_t status);
+void frame_received(const uint8_t* rx, uint8_t len);
+uint8_t command_pending(void);
+
+// Last command from the master ('1' or '0'), 0 when handled
+__IO uint8_t command;
+
+int main(void)
+{
+	uint8_t blink = 0, led = 0;
+	uint32_t lastToggle = 0, elapsed;
+	
+	DelayInit();
+	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	led_init();
+	
+	spi_slave_init(frame_received);
+	status_stage(blink);
+	lcd16x2_puts("LED Blinking Off");
+	
+	while (1)
+	{
+		if (command)
+		{
+			blink = (command == '1');
+			command = 0;
+			// Answer for the next frame is ready long before the master
+			// starts it
+			status_stage(blink);
+			// Display LED blinking status
+			lcd16x2_clrscr();
+			if (blink)
+			{
+				lcd16x2_puts("LED Blinking On");
+			}
+			else
+			{
+				lcd16x2_puts("LED Blinking Off");
+			}
+		}
+		
+		// Blink LED at 2 Hz, off while blinking is disabled
+		if ((DelayGetMs() - lastToggle) >= 250)
+		{
+			lastToggle += 250;
+			led = blink ? !led : 0;
+			GPIO_WriteBit(LED_GPIO, LED_PIN, led ? Bit_RESET : Bit_SET);
+		}
+		
+		// Sleep until the next LED toggle, a frame wakes up earlier
+		elapsed = DelayGetMs() - lastToggle;
+		DelayIdleUntil(command_pending, (elapsed < 250) ? (250 - elapsed) : 0);
+	}
+}
+
+void led_init()
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+	
+	RCC_APB2PeriphClockCmd(LED_GPIO_RCC, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = LED_PIN;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
+	GPIO_Init(LED_GPIO, &GPIO_InitStruct);
+	// Blue Pill LED is active low
+	GPIO_SetBits(LED_GPIO, LED_PIN);
+}
+
+void status_stage(uint8_t status)
+{
+	uint8_t* response = spi_slave_response();
+	
+	response[0] = 0;
+	response[STATUS_INDEX] = status;
+	spi_slave_stage(STATUS_INDEX + 1);
+}
+
+void frame_received(const uint8_t* rx, uint8_t len)
+{
+	uint8_t i;
+	
+	// Last LED command of the frame wins, '?' needs no action because
+	// the status is always staged
+	for (i = 0; i < len; i++)
+	{
+		if ((rx[i] == '0') || (rx[i] == '1'))
+		{
+			command = rx[i];
+		}
+	}
+}
+
+uint8_t command_pending()
+{
+	return command != 0;
+}
@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file		spi_slave.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "spi_slave.h"
+#include <string.h>
+
+/** Private defines --------------------------------------------------------- */
+#define NSS_BIT			(1 << SPI_NSS_LINE)
+
+/** Private variables ------------------------------------------------------- */
+static spi_slave_callback_t frameCallback;
+// Response triple buffer: one read by DMA, one staged for the next frame
+// and one written by the main loop, so neither side ever waits
+static uint8_t txBuf[3][SPI_SLAVE_FRAME_SIZE];
+static uint8_t txActive;
+static __IO uint8_t txReady;
+static uint8_t txFill;
+static __IO uint8_t txPending;
+// Receive double buffer, the finished one is handed to the callback
+static uint8_t rxBuf[2][SPI_SLAVE_FRAME_SIZE];
+static uint8_t rxActive;
+// SPI configuration restored after the reset at every frame end
+static uint16_t spiCr1;
+static __IO uint32_t frames;
+
+/** Private function prototypes --------------------------------------------- */
+static void spi_slave_arm(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize SPI slave with DMA and NSS edge interrupt
+  * @param	Function called at the end of every frame, may be 0
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_slave_init(spi_slave_callback_t callback)
+{
+	// Initialization struct
+	SPI_InitTypeDef SPI_InitStruct;
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	
+	frameCallback = callback;
+	txActive = 0;
+	txReady = 1;
+	txFill = 2;
+	
+	// Step 1: Initialize SPI, hardware NSS makes the slave ignore SCK and
+	// release MISO while it is not selected
+	RCC_APB2PeriphClockCmd(SPIx_RCC, ENABLE);
+	SPI_InitStruct.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_2;
+	SPI_InitStruct.SPI_CPHA = SPI_CPHA_1Edge;
+	SPI_InitStruct.SPI_CPOL = SPI_CPOL_Low;
+	SPI_InitStruct.SPI_DataSize = SPI_DataSize_8b;
+	SPI_InitStruct.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+	SPI_InitStruct.SPI_FirstBit = SPI_FirstBit_MSB;
+	SPI_InitStruct.SPI_Mode = SPI_Mode_Slave;
+	SPI_InitStruct.SPI_NSS = SPI_NSS_Hard;
+	SPI_Init(SPIx, &SPI_InitStruct);
+	spiCr1 = SPIx->CR1 & ~SPI_CR1_SPE;
+	
+	// Step 2: Initialize GPIO, only MISO is driven by the slave
+	RCC_APB2PeriphClockCmd(SPI_GPIO_RCC | RCC_APB2Periph_AFIO, ENABLE);
+	GPIO_InitStruct.GPIO_Pin = SPI_PIN_MISO;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
+	GPIO_InitStruct.GPIO_Pin = SPI_PIN_MOSI | SPI_PIN_SCK | SPI_PIN_NSS;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+	GPIO_Init(SPI_GPIO, &GPIO_InitStruct);
+	
+	// Step 3: DMA, peripheral address is SPI data register
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	SPI_DMA_RX_CHANNEL->CPAR = (uint32_t) &SPIx->DR;
+	SPI_DMA_TX_CHANNEL->CPAR = (uint32_t) &SPIx->DR;
+	spi_slave_arm();
+	
+	// Step 4: Both NSS edges interrupt, the rising edge ends a frame
+	AFIO->EXTICR[SPI_NSS_LINE / 4] = 
+		(AFIO->EXTICR[SPI_NSS_LINE / 4] & ~(0xF << ((SPI_NSS_LINE % 4) * 4))) |
+		(SPI_NSS_PORT << ((SPI_NSS_LINE % 4) * 4));
+	EXTI->RTSR |= NSS_BIT;
+	EXTI->FTSR |= NSS_BIT;
+	EXTI->PR = NSS_BIT;
+	EXTI->IMR |= NSS_BIT;
+	NVIC_InitStruct.NVIC_IRQChannel = SPI_NSS_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the response buffer owned by the main loop
+  * @param	None
+  * @retval	Buffer of SPI_SLAVE_FRAME_SIZE bytes, valid until spi_slave_stage()
+  ******************************************************************************
+  */
+uint8_t* spi_slave_response()
+{
+	return txBuf[txFill];
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Stage the response buffer for the next frame. It is sent in
+  *					every following frame until a new response is staged.
+  * @param	Number of valid bytes, the rest of the frame is sent as 0
+  * @retval	None
+  ******************************************************************************
+  */
+void spi_slave_stage(uint8_t len)
+{
+	uint8_t index;
+	
+	if (len < SPI_SLAVE_FRAME_SIZE)
+	{
+		memset(&txBuf[txFill][len], 0, SPI_SLAVE_FRAME_SIZE - len);
+	}
+	
+	// Swap fill and ready buffers, the frame end interrupt swaps ready
+	// and active
+	NVIC_DisableIRQ(SPI_NSS_IRQn);
+	index = txReady;
+	txReady = txFill;
+	txFill = index;
+	txPending = 1;
+	NVIC_EnableIRQ(SPI_NSS_IRQn);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of frames received since init
+  * @param	None
+  * @retval	Frame count
+  ******************************************************************************
+  */
+uint32_t spi_slave_frames()
+{
+	return frames;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	NSS edge interrupt handler
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void SPI_NSS_IRQHandler(void)
+{
+	uint8_t len, done, index;
+	
+	EXTI->PR = NSS_BIT;
+	
+	// Falling edge: DMA is already armed, nothing to do
+	if (!(SPI_GPIO->IDR & SPI_PIN_NSS))
+	{
+		return;
+	}
+	
+	// Rising edge ends the frame, receive into the other buffer and send
+	// the staged response from now on
+	len = SPI_SLAVE_FRAME_SIZE - SPI_DMA_RX_CHANNEL->CNDTR;
+	done = rxActive;
+	rxActive ^= 1;
+	if (txPending)
+	{
+		txPending = 0;
+		index = txActive;
+		txActive = txReady;
+		txReady = index;
+	}
+	spi_slave_arm();
+	frames++;
+	
+	if (frameCallback && len)
+	{
+		frameCallback(rxBuf[done], len);
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Reset SPI and arm DMA for the next frame
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void spi_slave_arm()
+{
+	// A slave cannot flush the byte already loaded into DR by TX DMA, it
+	// would be sent first in the next frame. Reset the peripheral instead.
+	SPI_DMA_RX_CHANNEL->CCR = 0;
+	SPI_DMA_TX_CHANNEL->CCR = 0;
+	DMA1->IFCR = SPI_DMA_CLEAR;
+	RCC_APB2PeriphResetCmd(SPIx_RCC, ENABLE);
+	RCC_APB2PeriphResetCmd(SPIx_RCC, DISABLE);
+	SPIx->CR1 = spiCr1;
+	SPIx->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+	
+	// RX has the higher priority so it is never overrun by TX
+	SPI_DMA_RX_CHANNEL->CMAR = (uint32_t) rxBuf[rxActive];
+	SPI_DMA_RX_CHANNEL->CNDTR = SPI_SLAVE_FRAME_SIZE;
+	SPI_DMA_RX_CHANNEL->CCR = DMA_CCR1_PL_1 | DMA_CCR1_MINC | DMA_CCR1_EN;
+	SPI_DMA_TX_CHANNEL->CMAR = (uint32_t) txBuf[txActive];
+	SPI_DMA_TX_CHANNEL->CNDTR = SPI_SLAVE_FRAME_SIZE;
+	SPI_DMA_TX_CHANNEL->CCR = DMA_CCR1_PL_0 | DMA_CCR1_MINC | DMA_CCR1_DIR | 
+		DMA_CCR1_EN;
+	
+	// TX DMA preloads the first byte as soon as SPI is enabled
+	SPIx->CR1 = spiCr1 | SPI_CR1_SPE;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file		spi_slave.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		DMA driven SPI slave. A frame is everything clocked while NSS
+	*					is low. The response of a frame is staged by the main loop
+	*					before the frame starts, so the master can read it back to back
+	*					with its command. The reply in a frame therefore answers the
+	*					previous frame (command/response pipelining).
+  ******************************************************************************
+  */
+
+#ifndef __SPI_SLAVE_H
+#define __SPI_SLAVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_spi.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define SPIx_RCC				RCC_APB2Periph_SPI1
+#define SPIx						SPI1
+#define SPI_GPIO_RCC		RCC_APB2Periph_GPIOA
+#define SPI_GPIO				GPIOA
+#define SPI_PIN_MOSI		GPIO_Pin_7
+#define SPI_PIN_MISO		GPIO_Pin_6
+#define SPI_PIN_SCK			GPIO_Pin_5
+#define SPI_PIN_NSS			GPIO_Pin_4
+
+// NSS edges on EXTI line 4
+#define SPI_NSS_PORT					0		// AFIO_EXTICR port source (0 = A, 1 = B)
+#define SPI_NSS_LINE					4
+#define SPI_NSS_IRQn					EXTI4_IRQn
+#define SPI_NSS_IRQHandler		EXTI4_IRQHandler
+
+// DMA channels for SPI1 (use channel 4/5 for SPI2)
+#define SPI_DMA_RX_CHANNEL		DMA1_Channel2
+#define SPI_DMA_TX_CHANNEL		DMA1_Channel3
+#define SPI_DMA_CLEAR					(DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3)
+
+// Max bytes of a frame, longer frames are truncated
+#define SPI_SLAVE_FRAME_SIZE	32
+
+/** Typedefs ---------------------------------------------------------------- */
+// Called from interrupt when NSS goes high, with the bytes of the frame.
+// The buffer is valid until the end of the next frame.
+typedef void (*spi_slave_callback_t)(const uint8_t* rx, uint8_t len);
+
+/** Public function prototypes ---------------------------------------------- */
+void spi_slave_init(spi_slave_callback_t callback);
+uint8_t* spi_slave_response(void);
+void spi_slave_stage(uint8_t len);
+uint32_t spi_slave_frames(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
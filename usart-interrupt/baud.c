@@ -0,0 +1,271 @@
+/**
+  ******************************************************************************
+  * @file		baud.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "baud.h"
+
+/** Private defines --------------------------------------------------------- */
+// Falling edges of a 0x55 char: start bit, d1, d3, d5, d7
+#define SYNC_EDGES			5
+#define SYNC_BITS				8
+
+/** Private variables ------------------------------------------------------- */
+// Rates the measurement is snapped to
+static const uint32_t standardRates[] =
+{
+	9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+	1000000, 1500000, 2000000, 2250000, 3000000, 4000000, 4500000
+};
+// Last SYNC_EDGES capture times
+static uint16_t edges[SYNC_EDGES];
+static uint8_t edgeCount;
+static __IO uint32_t detected;
+
+/** Private function prototypes --------------------------------------------- */
+static uint32_t baud_timer_clock(void);
+static uint32_t baud_snap(uint32_t baud);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Get the clock of a USART (APB2 for USART1, APB1 for the others)
+  * @param	USART
+  * @retval	Clock in Hz
+  ******************************************************************************
+  */
+uint32_t baud_clock(USART_TypeDef* usart)
+{
+	RCC_ClocksTypeDef clocks;
+
+	RCC_GetClocksFreq(&clocks);
+
+	return (usart == USART1) ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Compute BRR for a rate. BRR is the clock divided by the rate in
+  *					1/16 steps (mantissa and 4 fraction bits), at least 16.
+  * @param	USART
+  * @param	Rate in baud
+  * @param	Pointer to store the result
+  * @retval	1 if the rate is possible within BAUD_MAX_ERROR_PPM, otherwise 0
+  ******************************************************************************
+  */
+uint8_t baud_calc(USART_TypeDef* usart, uint32_t baud, baud_calc_t* calc)
+{
+	uint32_t clock = baud_clock(usart);
+	uint32_t brr;
+
+	calc->baud = baud;
+	calc->brr = 0;
+	calc->actual = 0;
+	calc->error_ppm = 0;
+	if (baud == 0)
+	{
+		return 0;
+	}
+
+	brr = (clock + (baud / 2)) / baud;
+	if ((brr < 16) || (brr > 0xFFFF))
+	{
+		return 0;
+	}
+	calc->brr = brr;
+	calc->actual = (clock + (brr / 2)) / brr;
+	calc->error_ppm = (int32_t)(((int64_t) calc->actual - baud) * 1000000 / baud);
+
+	return (calc->error_ppm <= BAUD_MAX_ERROR_PPM) && 
+		(calc->error_ppm >= -BAUD_MAX_ERROR_PPM);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Change the rate after the last char has been sent
+  * @param	USART
+  * @param	Rate in baud
+  * @retval	1 if changed, 0 if the rate is not possible
+  ******************************************************************************
+  */
+uint8_t baud_set(USART_TypeDef* usart, uint32_t baud)
+{
+	baud_calc_t calc;
+
+	if (!baud_calc(usart, baud, &calc))
+	{
+		return 0;
+	}
+
+	// Changing BRR in the middle of a char would corrupt it
+	while (!(usart->SR & USART_SR_TC));
+	usart->BRR = calc.brr;
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start auto-baud, the host must send 0x55 chars until
+  *					baud_detect_result() returns a rate
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void baud_detect_start()
+{
+	NVIC_InitTypeDef NVIC_InitStruct;
+
+	detected = 0;
+	edgeCount = 0;
+
+	// Free running 16-bit counter at full timer clock, capture channel 4
+	// on falling edges of its own input (TI4)
+	RCC_APB1PeriphClockCmd(BAUD_TIM_RCC, ENABLE);
+	BAUD_TIM->CR1 = 0;
+	BAUD_TIM->PSC = 0;
+	BAUD_TIM->ARR = 0xFFFF;
+	BAUD_TIM->CCMR2 = TIM_CCMR2_CC4S_0;
+	BAUD_TIM->CCER = TIM_CCER_CC4E | TIM_CCER_CC4P;
+	BAUD_TIM->EGR = TIM_EGR_UG;
+	BAUD_TIM->SR = 0;
+	BAUD_TIM->DIER = TIM_DIER_CC4IE;
+	BAUD_TIM->CR1 = TIM_CR1_CEN;
+
+	NVIC_InitStruct.NVIC_IRQChannel = BAUD_TIM_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Stop auto-baud and the timer
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void baud_detect_stop()
+{
+	BAUD_TIM->DIER = 0;
+	BAUD_TIM->CR1 = 0;
+	NVIC_DisableIRQ(BAUD_TIM_IRQn);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the detected rate
+  * @param	None
+  * @retval	Rate in baud, 0 while still waiting for a sync char
+  ******************************************************************************
+  */
+uint32_t baud_detect_result()
+{
+	return detected;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Timer interrupt handler, one falling edge of the RX pin
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void BAUD_TIM_IRQHandler(void)
+{
+	uint16_t total, interval, expected;
+	uint8_t i;
+
+	if (!(BAUD_TIM->SR & TIM_SR_CC4IF))
+	{
+		return;
+	}
+
+	// Reading CCR4 clears the flag, keep the last SYNC_EDGES captures
+	if (edgeCount == SYNC_EDGES)
+	{
+		for (i = 1; i < SYNC_EDGES; i++)
+		{
+			edges[i - 1] = edges[i];
+		}
+		edgeCount--;
+	}
+	edges[edgeCount++] = BAUD_TIM->CCR4;
+	if (edgeCount < SYNC_EDGES)
+	{
+		return;
+	}
+
+	// A sync char has evenly spaced edges, anything else (idle gaps,
+	// other chars) fails within +-25 % and the window slides on
+	total = edges[SYNC_EDGES - 1] - edges[0];
+	expected = total / (SYNC_EDGES - 1);
+	for (i = 1; i < SYNC_EDGES; i++)
+	{
+		interval = edges[i] - edges[i - 1];
+		if ((interval < (expected - expected / 4)) || 
+			(interval > (expected + expected / 4)))
+		{
+			return;
+		}
+	}
+	if (total == 0)
+	{
+		return;
+	}
+
+	detected = baud_snap((baud_timer_clock() * SYNC_BITS + total / 2) / total);
+	baud_detect_stop();
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Get the clock of the capture timer
+  * @param	None
+  * @retval	Clock in Hz
+  ******************************************************************************
+  */
+static uint32_t baud_timer_clock()
+{
+	RCC_ClocksTypeDef clocks;
+
+	// Timer clock is twice the bus clock when the APB prescaler is not 1
+	RCC_GetClocksFreq(&clocks);
+
+	return (clocks.PCLK1_Frequency == clocks.HCLK_Frequency) ? 
+		clocks.PCLK1_Frequency : (clocks.PCLK1_Frequency * 2);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Snap a measured rate to a close standard rate
+  * @param	Measured rate in baud
+  * @retval	Standard rate, or the measured rate if none is close
+  ******************************************************************************
+  */
+static uint32_t baud_snap(uint32_t baud)
+{
+	uint32_t diff;
+	uint8_t i;
+
+	for (i = 0; i < sizeof(standardRates) / sizeof(standardRates[0]); i++)
+	{
+		diff = (baud > standardRates[i]) ? 
+			(baud - standardRates[i]) : (standardRates[i] - baud);
+		if (((uint64_t) diff * 1000000) <= ((uint64_t) standardRates[i] * BAUD_SNAP_PPM))
+		{
+			return standardRates[i];
+		}
+	}
+
+	return baud;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file		baud.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Baud rate engine. BRR is computed for any rate from the clock
+	*					of the USART's bus: USART1 on APB2 (72 MHz, up to 4.5 Mbaud),
+	*					USART2/3 on APB1 (36 MHz, up to 2.25 Mbaud). Auto-baud times
+	*					the falling edges of a 0x55 sync char ('U') on the RX pin with
+	*					a timer input capture: they are 2 bit times apart and the
+	*					first and fifth are 8 bit times apart.
+  ******************************************************************************
+  */
+
+#ifndef __BAUD_H
+#define __BAUD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "misc.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Input capture on the RX pin of USART2 (PA3 = TIM2_CH4),
+// use TIM1_CH3 (PA10) for USART1
+#define BAUD_TIM							TIM2
+#define BAUD_TIM_RCC					RCC_APB1Periph_TIM2
+#define BAUD_TIM_IRQn					TIM2_IRQn
+#define BAUD_TIM_IRQHandler		TIM2_IRQHandler
+
+// Largest rate error accepted by baud_calc(), receivers tolerate a few %
+#define BAUD_MAX_ERROR_PPM		15000
+// Measured rate is snapped to a standard rate this close to it
+#define BAUD_SNAP_PPM					30000
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint32_t baud;					// Requested rate
+	uint32_t actual;				// Rate the USART will really run at
+	int32_t error_ppm;			// (actual - baud) / baud in ppm
+	uint16_t brr;
+} baud_calc_t;
+
+/** Public function prototypes ---------------------------------------------- */
+uint32_t baud_clock(USART_TypeDef* usart);
+uint8_t baud_calc(USART_TypeDef* usart, uint32_t baud, baud_calc_t* calc);
+uint8_t baud_set(USART_TypeDef* usart, uint32_t baud);
+void baud_detect_start(void);
+void baud_detect_stop(void);
+uint32_t baud_detect_result(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file		fmt.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Allocation-free replacement for sprintf when printing numbers
+	*					to LCD or USART. Every function writes exactly the number of
+	*					chars it returns and never writes a null terminator, so fields
+	*					can be rendered straight into a fixed-width line buffer.
+  ******************************************************************************
+  */
+
+#ifndef __FMT_H
+#define __FMT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Pad chars for fixed width fields
+#define FMT_PAD_ZERO			'0'
+#define FMT_PAD_SPACE			' '
+// Char used to fill a field when the value does not fit in it
+#define FMT_OVERFLOW			'*'
+
+// Max chars of a 32-bit decimal value including sign
+#define FMT_DEC_MAX				11
+
+/** Public function prototypes ---------------------------------------------- */
+void fmt_line_init(char* line, uint8_t len);
+uint8_t fmt_fill(char* dst, char c, uint8_t len);
+uint8_t fmt_str(char* dst, const char* s, uint8_t width);
+uint8_t fmt_dec(char* dst, uint32_t val, uint8_t width, char pad);
+uint8_t fmt_int(char* dst, int32_t val, uint8_t width, char pad);
+uint8_t fmt_hex(char* dst, uint32_t val, uint8_t digits);
+uint8_t fmt_fixed(char* dst, int32_t val, uint8_t frac_bits, uint8_t decimals,
+	uint8_t width);
+uint8_t fmt_2digit(char* dst, uint8_t val);
+uint8_t fmt_time(char* dst, uint8_t hours, uint8_t minutes, uint8_t seconds);
+uint8_t fmt_date(char* dst, uint8_t date, uint8_t month, uint8_t year);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,472 @@
+/**
+  ******************************************************************************
+  * @file		frame.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "frame.h"
+#include <string.h>
+
+/** Private variables ------------------------------------------------------- */
+static const frame_handler_t* handlerTable;
+static uint8_t handlerCount;
+static ring_t* rxRing;
+// Bytes after the RX ring tail already searched for a delimiter
+static uint16_t rxScanned;
+// Only used for frames that wrap around the end of the RX ring
+static uint8_t rxCopy[FRAME_MAX_ENCODED];
+// Sequence number of the last reliable frame received
+static uint8_t rxSeq;
+static uint8_t rxSeqValid;
+static uint8_t txSeq;
+// Encoded ACKs and unreliable frames, copied to the TX ring at once
+static uint8_t txBuf[FRAME_MAX_ENCODED];
+// Encoded reliable frame kept for retransmission until ACKed
+static uint8_t pendingBuf[FRAME_MAX_ENCODED];
+static uint16_t pendingLen;
+static uint8_t pendingSeq;
+static uint8_t pendingRetries;
+static uint32_t pendingTime;
+static uint8_t pending;
+// COBS encoder output and position of the current code byte
+static uint8_t* cobsOut;
+static uint8_t* cobsCode;
+// Partial word for the CRC unit
+static uint32_t crcWord;
+static uint8_t crcBytes;
+static frame_stats_t stats;
+
+/** Private function prototypes --------------------------------------------- */
+static uint16_t frame_encode(uint8_t* buf, uint8_t seq, uint8_t type, 
+	uint8_t flags, const uint8_t* data, uint16_t len);
+static void frame_receive(uint8_t* data, uint16_t len);
+static uint16_t frame_cobs_decode(uint8_t* data, uint16_t len);
+static void frame_cobs_put(uint8_t byte);
+static void frame_crc_reset(void);
+static void frame_crc_feed(const uint8_t* data, uint16_t len);
+static uint32_t frame_crc_result(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize framing on top of the USART, usart_init() must be
+  *					called first
+  * @param	Handler table, must stay valid
+  * @param	Number of handlers
+  * @retval	None
+  ******************************************************************************
+  */
+void frame_init(const frame_handler_t* handlers, uint8_t count)
+{
+	handlerTable = handlers;
+	handlerCount = count;
+	rxRing = usart_rx_ring();
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC, ENABLE);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Send a frame, never blocks
+  * @param	Frame type (1 to 255)
+  * @param	Payload, may be 0 if len is 0
+  * @param	Payload length, up to FRAME_MAX_PAYLOAD
+  * @param	FRAME_FLAG_RELIABLE to get it ACKed and retransmitted, or 0
+  * @retval	FRAME_OK or FRAME_ERR_xxx
+  ******************************************************************************
+  */
+uint8_t frame_send(uint8_t type, const void* data, uint16_t len, uint8_t flags)
+{
+	uint8_t reliable = flags & FRAME_FLAG_RELIABLE;
+	uint8_t* buf = reliable ? pendingBuf : txBuf;
+	uint16_t n;
+
+	if (len > FRAME_MAX_PAYLOAD)
+	{
+		return FRAME_ERR_SIZE;
+	}
+	if (reliable && pending)
+	{
+		return FRAME_ERR_BUSY;
+	}
+
+	// A frame is queued whole or not at all
+	n = frame_encode(buf, txSeq, type, flags, (const uint8_t*) data, len);
+	if (usart_tx_free() < n)
+	{
+		return FRAME_ERR_FULL;
+	}
+	usart_write(buf, n);
+
+	if (reliable)
+	{
+		pending = 1;
+		pendingSeq = txSeq;
+		pendingLen = n;
+		pendingRetries = 0;
+		pendingTime = DelayGetMs();
+	}
+	txSeq++;
+	stats.tx_frames++;
+
+	return FRAME_OK;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Dispatch received frames and retransmit an unACKed frame.
+  *					Call this from the main loop.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void frame_process()
+{
+	uint16_t count, index, len, first;
+	uint8_t* data;
+
+	while (1)
+	{
+		// Look for the next delimiter, continuing where the last call stopped
+		count = ring_count(rxRing);
+		while ((rxScanned < count) && 
+			(rxRing->buf[(rxRing->tail + rxScanned) & rxRing->mask] != 0))
+		{
+			rxScanned++;
+		}
+		if (rxScanned == count)
+		{
+			// No delimiter yet. Data longer than any frame is garbage,
+			// drop it to resynchronize on the next delimiter.
+			if (count >= FRAME_MAX_ENCODED)
+			{
+				ring_skip(rxRing, count);
+				stats.oversized += count;
+				rxScanned = 0;
+			}
+			break;
+		}
+
+		len = rxScanned;
+		index = rxRing->tail & rxRing->mask;
+		if (len >= FRAME_MAX_ENCODED)
+		{
+			stats.oversized += len;
+		}
+		else if (len)
+		{
+			if ((index + len) <= (rxRing->mask + 1))
+			{
+				// Decode in place, COBS never grows when decoding
+				data = &rxRing->buf[index];
+			}
+			else
+			{
+				first = rxRing->mask + 1 - index;
+				memcpy(rxCopy, &rxRing->buf[index], first);
+				memcpy(&rxCopy[first], rxRing->buf, len - first);
+				data = rxCopy;
+				stats.rx_copied++;
+			}
+			frame_receive(data, len);
+		}
+		// Release the frame and its delimiter
+		ring_skip(rxRing, len + 1);
+		rxScanned = 0;
+	}
+
+	if (pending && ((DelayGetMs() - pendingTime) >= FRAME_ACK_TIMEOUT_MS))
+	{
+		if (pendingRetries >= FRAME_RETRIES)
+		{
+			pending = 0;
+			stats.ack_timeouts++;
+		}
+		else if (usart_tx_free() >= pendingLen)
+		{
+			usart_write(pendingBuf, pendingLen);
+			pendingRetries++;
+			pendingTime = DelayGetMs();
+			stats.retransmits++;
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether a reliable frame is waiting for its ACK
+  * @param	None
+  * @retval	1 if waiting, otherwise 0
+  ******************************************************************************
+  */
+uint8_t frame_pending()
+{
+	return pending;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether bytes arrived that frame_process() has not scanned
+  * @param	None
+  * @retval	1 if there is new data, otherwise 0
+  ******************************************************************************
+  */
+uint8_t frame_rx_ready()
+{
+	return ring_count(rxRing) > rxScanned;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get frame statistics
+  * @param	None
+  * @retval	Pointer to statistics
+  ******************************************************************************
+  */
+const frame_stats_t* frame_get_stats()
+{
+	return &stats;
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Build an encoded frame including the delimiter
+  * @param	Output buffer of FRAME_MAX_ENCODED bytes
+  * @param	Sequence number
+  * @param	Type
+  * @param	Flags
+  * @param	Payload
+  * @param	Payload length
+  * @retval	Encoded length
+  ******************************************************************************
+  */
+static uint16_t frame_encode(uint8_t* buf, uint8_t seq, uint8_t type, 
+	uint8_t flags, const uint8_t* data, uint16_t len)
+{
+	uint8_t header[FRAME_HEADER_SIZE];
+	uint32_t crc;
+	uint16_t i;
+
+	header[0] = seq;
+	header[1] = type;
+	header[2] = flags;
+	frame_crc_reset();
+	frame_crc_feed(header, sizeof(header));
+	frame_crc_feed(data, len);
+	crc = frame_crc_result();
+
+	// Encode straight from header, payload and CRC without assembling them
+	cobsOut = buf + 1;
+	cobsCode = buf;
+	*cobsCode = 1;
+	for (i = 0; i < sizeof(header); i++)
+	{
+		frame_cobs_put(header[i]);
+	}
+	for (i = 0; i < len; i++)
+	{
+		frame_cobs_put(data[i]);
+	}
+	for (i = 0; i < FRAME_CRC_SIZE; i++)
+	{
+		frame_cobs_put(crc >> (i * 8));
+	}
+	*cobsOut++ = 0;
+
+	return cobsOut - buf;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check and dispatch one received frame
+  * @param	Encoded frame without delimiter, decoded in place
+  * @param	Encoded length
+  * @retval	None
+  ******************************************************************************
+  */
+static void frame_receive(uint8_t* data, uint16_t len)
+{
+	frame_view_t view;
+	uint32_t crc;
+	uint16_t n;
+	uint8_t i;
+
+	len = frame_cobs_decode(data, len);
+	if (len < (FRAME_HEADER_SIZE + FRAME_CRC_SIZE))
+	{
+		stats.cobs_errors++;
+		return;
+	}
+	n = len - FRAME_CRC_SIZE;
+	frame_crc_reset();
+	frame_crc_feed(data, n);
+	crc = data[n] | ((uint32_t) data[n + 1] << 8) | 
+		((uint32_t) data[n + 2] << 16) | ((uint32_t) data[n + 3] << 24);
+	if (crc != frame_crc_result())
+	{
+		stats.crc_errors++;
+		return;
+	}
+
+	view.seq = data[0];
+	view.type = data[1];
+	view.flags = data[2];
+	view.data = &data[FRAME_HEADER_SIZE];
+	view.len = n - FRAME_HEADER_SIZE;
+
+	if (view.type == FRAME_TYPE_ACK)
+	{
+		if (pending && (view.seq == pendingSeq))
+		{
+			pending = 0;
+		}
+		return;
+	}
+
+	if (view.flags & FRAME_FLAG_RELIABLE)
+	{
+		// ACK every copy, the previous ACK may have been lost
+		n = frame_encode(txBuf, view.seq, FRAME_TYPE_ACK, 0, 0, 0);
+		if (usart_tx_free() >= n)
+		{
+			usart_write(txBuf, n);
+		}
+		if (rxSeqValid && (view.seq == rxSeq))
+		{
+			stats.rx_duplicates++;
+			return;
+		}
+		rxSeq = view.seq;
+		rxSeqValid = 1;
+	}
+
+	for (i = 0; i < handlerCount; i++)
+	{
+		if (handlerTable[i].type == view.type)
+		{
+			stats.rx_frames++;
+			handlerTable[i].handler(&view);
+			return;
+		}
+	}
+	stats.unhandled++;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	COBS decode in place
+  * @param	Encoded data without delimiter
+  * @param	Encoded length
+  * @retval	Decoded length, 0 on encoding error
+  ******************************************************************************
+  */
+static uint16_t frame_cobs_decode(uint8_t* data, uint16_t len)
+{
+	const uint8_t* in = data;
+	const uint8_t* end = data + len;
+	uint8_t* out = data;
+	uint8_t code, i;
+
+	while (in < end)
+	{
+		code = *in++;
+		for (i = 1; i < code; i++)
+		{
+			if (in >= end)
+			{
+				return 0;
+			}
+			*out++ = *in++;
+		}
+		// Every block except a full one and the last ends with a zero
+		if ((code != 0xFF) && (in < end))
+		{
+			*out++ = 0;
+		}
+	}
+
+	return out - data;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Append one byte to the COBS encoder output
+  * @param	Byte
+  * @retval	None
+  ******************************************************************************
+  */
+static void frame_cobs_put(uint8_t byte)
+{
+	if (byte)
+	{
+		*cobsOut++ = byte;
+		(*cobsCode)++;
+		if (*cobsCode != 0xFF)
+		{
+			return;
+		}
+	}
+	// Zero or full block: close the block and start a new one
+	cobsCode = cobsOut++;
+	*cobsCode = 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start a CRC calculation
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void frame_crc_reset()
+{
+	CRC->CR = CRC_CR_RESET;
+	crcWord = 0;
+	crcBytes = 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Feed bytes to the CRC unit as little endian words
+  * @param	Data
+  * @param	Number of bytes
+  * @retval	None
+  ******************************************************************************
+  */
+static void frame_crc_feed(const uint8_t* data, uint16_t len)
+{
+	while (len--)
+	{
+		crcWord |= (uint32_t) *data++ << (crcBytes * 8);
+		if (++crcBytes == 4)
+		{
+			CRC->DR = crcWord;
+			crcWord = 0;
+			crcBytes = 0;
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the CRC, the last partial word is padded with zeros
+  * @param	None
+  * @retval	CRC-32
+  ******************************************************************************
+  */
+static uint32_t frame_crc_result()
+{
+	if (crcBytes)
+	{
+		CRC->DR = crcWord;
+		crcBytes = 0;
+	}
+
+	return CRC->DR;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
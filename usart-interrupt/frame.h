@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file		frame.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Binary frames over the USART link. On the wire a frame is the
+	*					COBS encoding of seq, type, flags, payload and CRC-32, followed
+	*					by a 0x00 delimiter. The CRC comes from the hardware CRC unit
+	*					(poly 0x04C11DB7, init 0xFFFFFFFF, no reflection, no final XOR)
+	*					over the header and payload read as little endian 32-bit
+	*					words, the last word padded with zeros, and is sent little
+	*					endian. Frames sent with FRAME_FLAG_RELIABLE are ACKed by the
+	*					receiver and retransmitted by the sender until ACKed.
+	*					Received frames are decoded in place in the RX ring and handed
+	*					to the handlers as views, without copying.
+  ******************************************************************************
+  */
+
+#ifndef __FRAME_H
+#define __FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "delay.h"
+#include "usart_dma.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define FRAME_MAX_PAYLOAD			128
+#define FRAME_HEADER_SIZE			3
+#define FRAME_CRC_SIZE				4
+// Worst case encoded size: one COBS code byte per 254 bytes, and delimiter
+#define FRAME_MAX_ENCODED			(FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + \
+	FRAME_CRC_SIZE + ((FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + \
+	FRAME_CRC_SIZE) / 254) + 2)
+
+// Reliable frames: time to wait for the ACK and number of retransmissions
+#define FRAME_ACK_TIMEOUT_MS	20
+#define FRAME_RETRIES					3
+
+// Frame types, 0 is reserved for ACKs (payload empty, seq = ACKed seq)
+#define FRAME_TYPE_ACK				0
+
+// Frame flags
+#define FRAME_FLAG_RELIABLE		0x01
+
+// Status
+#define FRAME_OK							0
+#define FRAME_ERR_SIZE				1		// Payload too long
+#define FRAME_ERR_BUSY				2		// Previous reliable frame not ACKed yet
+#define FRAME_ERR_FULL				3		// Not enough space in the TX ring
+
+/** Typedefs ---------------------------------------------------------------- */
+// Received frame, data points into the RX ring and is only valid during
+// the handler call
+typedef struct
+{
+	uint8_t seq;
+	uint8_t type;
+	uint8_t flags;
+	const uint8_t* data;
+	uint16_t len;
+} frame_view_t;
+
+typedef void (*frame_callback_t)(const frame_view_t* frame);
+
+typedef struct
+{
+	uint8_t type;
+	frame_callback_t handler;
+} frame_handler_t;
+
+typedef struct
+{
+	uint32_t rx_frames;			// Frames delivered to handlers
+	uint32_t rx_copied;			// Frames copied because they wrapped the RX ring
+	uint32_t rx_duplicates;	// Retransmitted frames received again
+	uint32_t crc_errors;
+	uint32_t cobs_errors;		// Bad encoding or frame too short
+	uint32_t oversized;			// Bytes discarded without delimiter
+	uint32_t unhandled;			// Frames of a type without handler
+	uint32_t tx_frames;
+	uint32_t retransmits;
+	uint32_t ack_timeouts;	// Reliable frames given up after all retries
+} frame_stats_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void frame_init(const frame_handler_t* handlers, uint8_t count);
+uint8_t frame_send(uint8_t type, const void* data, uint16_t len, uint8_t flags);
+void frame_process(void);
+uint8_t frame_pending(void);
+uint8_t frame_rx_ready(void);
+const frame_stats_t* frame_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
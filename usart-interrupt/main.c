@@ -4,132 +4,176 @@
 #include "stm32f10x_usart.h"
 #include "delay.h"
 #include "lcd16x2.h"
-#include <string.h>
+#include "usart_dma.h"
+#include "frame.h"
+#include "baud.h"
+#include "fmt.h"
 
-void USART2_Init(void);
-void USART2_PutChar(char c);
-void USART2_PutString(char *s);
+// Rate until auto-baud or the host negotiates another one
+#define BAUD_DEFAULT				115200
+// Time the host has to confirm a new rate before falling back
+#define BAUD_CONFIRM_MS			500
 
-// Buffer for store received chars
-#define BUF_SIZE	16
-char buf[BUF_SIZE];
+// Frame types
+#define FRAME_TYPE_TEXT			1		// Text shown on the LCD and echoed back
+#define FRAME_TYPE_BAUD			2		// Rate request, see baud_received()
 
-void USART2_IRQHandler()
+void text_received(const frame_view_t* frame);
+void baud_received(const frame_view_t* frame);
+void baud_switch(uint32_t baud);
+void baud_display(void);
+
+const frame_handler_t handlers[] =
+{
+	{ FRAME_TYPE_TEXT, text_received },
+	{ FRAME_TYPE_BAUD, baud_received },
+};
+
+uint32_t baudCurrent = BAUD_DEFAULT;
+uint32_t baudPrevious;
+// Rate accepted by baud_received(), switched to once the reply is sent
+uint32_t baudRequested;
+uint32_t confirmStart;
+uint8_t confirming;
+uint8_t detecting;
+
+int main(void)
 {
-	// Check if the USART2 receive interrupt flag was set
-	if (USART_GetITStatus(USART2, USART_IT_RXNE))
+	uint32_t rate;
+	
+	DelayInit();
+	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	
+	// Initialize USART with RX and TX DMA, then framing on top of it
+	usart_init(BAUD_DEFAULT);
+	frame_init(handlers, sizeof(handlers) / sizeof(handlers[0]));
+	// Listen for 0x55 sync chars until the first frame arrives
+	baud_detect_start();
+	detecting = 1;
+	baud_display();
+	
+	while (1)
 	{
-		// Index for receive buffer
-		static uint8_t i = 0;
-		
-		// Read received char
-		char c = USART_ReceiveData(USART2);
+		// Received frames wait in the RX ring until the main loop gets here,
+		// DMA keeps receiving meanwhile
+		frame_process();
 		
-		// Read chars until newline
-		if (c != '\n')
+		if (detecting)
 		{
-			// Concat char to buffer
-			// If maximum buffer size is reached, then reset i to 0
-			if (i < BUF_SIZE - 1)
+			rate = baud_detect_result();
+			if (rate && baud_set(USARTx, rate))
 			{
-				buf[i] = c;
-				i++;
+				baudCurrent = rate;
+				detecting = 0;
+				baud_display();
 			}
-			else
+			else if (frame_get_stats()->rx_frames)
 			{
-				buf[i] = c;
-				i = 0;
+				// Host talks at the default rate
+				baud_detect_stop();
+				detecting = 0;
 			}
 		}
-		else
+		
+		if (baudRequested)
+		{
+			baud_switch(baudRequested);
+			baudRequested = 0;
+			confirming = 1;
+			confirmStart = DelayGetMs();
+		}
+		else if (confirming && 
+			((DelayGetMs() - confirmStart) >= BAUD_CONFIRM_MS))
 		{
-			// Display received string to LCD
-			lcd16x2_clrscr();
-			lcd16x2_puts(buf);
-			
-			// Echo received string to USART2
-			USART2_PutString(buf);
-			USART2_PutChar('\n');
-			
-			// Clear buffer
-			memset(&buf[0], 0, sizeof(buf));
-			i = 0;
+			// Host never got there, go back to the rate that worked
+			baud_switch(baudPrevious);
+			confirming = 0;
 		}
+		
+		// Nothing to do until a byte arrives (sync chars too), or until a
+		// reliable frame may need to be retransmitted or a new rate times out
+		DelayIdleUntil(frame_rx_ready, 
+			(frame_pending() || confirming) ? 1 : DELAY_IDLE_FOREVER);
 	}
 }
 
-int main(void)
+void text_received(const frame_view_t* frame)
 {
-	DelayInit();
-	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	char line[LCD16X2_DISP_LENGTH + 1];
+	uint8_t i;
 	
-	// Initialize USART with receive interrupt
-	USART2_Init();
-	
-	while (1)
+	// Display received text to LCD, cut to one line
+	for (i = 0; (i < frame->len) && (i < LCD16X2_DISP_LENGTH); i++)
 	{
+		line[i] = frame->data[i];
 	}
+	line[i] = '\0';
+	lcd16x2_gotoxy(0, 0);
+	lcd16x2_puts(line);
+	
+	// Echo back straight from the RX ring, as reliable as it was sent
+	frame_send(FRAME_TYPE_TEXT, frame->data, frame->len, frame->flags);
 }
 
-void USART2_Init()
+void baud_received(const frame_view_t* frame)
 {
-	// Initialization struct
-	USART_InitTypeDef USART_InitStruct;
-	GPIO_InitTypeDef GPIO_InitStruct;
-	NVIC_InitTypeDef NVIC_InitStruct;
+	// Request: rate (uint32 LE). Reply at the old rate: accepted rate
+	// (0 = rejected) and its error in ppm (int32 LE). Both sides then
+	// switch, and the host repeats the request at the new rate within
+	// BAUD_CONFIRM_MS to confirm it.
+	uint8_t reply[8];
+	baud_calc_t calc;
+	uint32_t rate, accepted;
+	uint8_t i;
 	
-	// Step 1: Initialize USART2
-	RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
-	USART_InitStruct.USART_BaudRate = 9600;
-	USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-	USART_InitStruct.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
-	USART_InitStruct.USART_Parity = USART_Parity_No;
-	USART_InitStruct.USART_StopBits = USART_StopBits_1;
-	USART_InitStruct.USART_WordLength = USART_WordLength_8b;
-	USART_Init(USART2, &USART_InitStruct);
-	USART_Cmd(USART2, ENABLE);
-	
-	// Step 2: Initialize GPIO for Tx and Rx pin
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
-	// Tx pin (PA2) initialization as push-pull alternate function
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_2;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(GPIOA, &GPIO_InitStruct);
-	// Rx pin (PA3) initialization as input floating
-	GPIO_InitStruct.GPIO_Pin = GPIO_Pin_3;
-	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
-	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_2MHz;
-	GPIO_Init(GPIOA, &GPIO_InitStruct);
+	if (frame->len != 4)
+	{
+		return;
+	}
+	rate = frame->data[0] | ((uint32_t) frame->data[1] << 8) | 
+		((uint32_t) frame->data[2] << 16) | ((uint32_t) frame->data[3] << 24);
 	
-	// Step 3: Enable USART receive interrupt
-	USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+	accepted = baud_calc(USARTx, rate, &calc) ? rate : 0;
+	for (i = 0; i < 4; i++)
+	{
+		reply[i] = accepted >> (i * 8);
+		reply[4 + i] = (uint32_t) calc.error_ppm >> (i * 8);
+	}
+	frame_send(FRAME_TYPE_BAUD, reply, sizeof(reply), 0);
 	
-	// Step 4: Initialize NVIC for USART IRQ
-	// Set NVIC prority group to group 4 
-	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
-	// Set System Timer IRQ at higher priority
-	NVIC_SetPriority(SysTick_IRQn, 0);
-	// Set USART2 IRQ at lower priority
-	NVIC_InitStruct.NVIC_IRQChannel = USART2_IRQn;
-	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
-	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
-	NVIC_Init(&NVIC_InitStruct);
+	if (confirming && (rate == baudCurrent))
+	{
+		confirming = 0;
+	}
+	else if (accepted && (rate != baudCurrent))
+	{
+		baudRequested = rate;
+	}
 }
 
-void USART2_PutChar(char c)
+void baud_switch(uint32_t baud)
 {
-	// Wait until transmit data register is empty
-	while (!USART_GetFlagStatus(USART2, USART_FLAG_TXE));
-	// Send a char using USART2
-	USART_SendData(USART2, c);
+	// Let the reply and any ACK go out at the old rate first
+	while (usart_tx_busy())
+	{
+		DelayIdle(1);
+	}
+	if (baud_set(USARTx, baud))
+	{
+		baudPrevious = baudCurrent;
+		baudCurrent = baud;
+		baud_display();
+	}
 }
 
-void USART2_PutString(char *s)
+void baud_display()
 {
-	// Send a string
-	while (*s)
-	{
-		USART2_PutChar(*s++);
-	}
+	char line[LCD16X2_DISP_LENGTH + 1];
+	uint8_t n;
+	
+	n = fmt_dec(line, baudCurrent, 8, FMT_PAD_SPACE);
+	n += fmt_str(&line[n], detecting ? " baud ?" : " baud", 8);
+	line[n] = '\0';
+	lcd16x2_gotoxy(0, 1);
+	lcd16x2_puts(line);
 }
@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file		ring.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "ring.h"
+#include <string.h>
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize an empty ring
+  * @param	Pointer to ring
+  * @param	Storage
+  * @param	Storage size in bytes, power of 2 up to 32768
+  * @retval	None
+  ******************************************************************************
+  */
+void ring_init(ring_t* ring, uint8_t* buf, uint16_t size)
+{
+	ring->buf = buf;
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get number of bytes in the ring
+  * @param	Pointer to ring
+  * @retval	Byte count
+  ******************************************************************************
+  */
+uint16_t ring_count(const ring_t* ring)
+{
+	return (uint16_t)(ring->head - ring->tail);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get free space of the ring
+  * @param	Pointer to ring
+  * @retval	Byte count
+  ******************************************************************************
+  */
+uint16_t ring_free(const ring_t* ring)
+{
+	return ring->mask + 1 - (uint16_t)(ring->head - ring->tail);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Append bytes (producer side)
+  * @param	Pointer to ring
+  * @param	Data
+  * @param	Number of bytes
+  * @retval	Number of bytes written, less than len when the ring is full
+  ******************************************************************************
+  */
+uint16_t ring_write(ring_t* ring, const uint8_t* data, uint16_t len)
+{
+	uint16_t head = ring->head;
+	uint16_t index = head & ring->mask;
+	uint16_t space = ring_free(ring);
+	uint16_t first;
+
+	if (len > space)
+	{
+		len = space;
+	}
+
+	// Copy up to the end of storage, then the rest from the start
+	first = ring->mask + 1 - index;
+	if (first > len)
+	{
+		first = len;
+	}
+	memcpy(&ring->buf[index], data, first);
+	memcpy(ring->buf, &data[first], len - first);
+
+	// Data must be in place before the consumer sees the new head
+	__DMB();
+	ring->head = head + len;
+
+	return len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Remove bytes (consumer side)
+  * @param	Pointer to ring
+  * @param	Buffer to store data
+  * @param	Max number of bytes
+  * @retval	Number of bytes read
+  ******************************************************************************
+  */
+uint16_t ring_read(ring_t* ring, uint8_t* data, uint16_t len)
+{
+	uint16_t tail = ring->tail;
+	uint16_t index = tail & ring->mask;
+	uint16_t count = ring_count(ring);
+	uint16_t first;
+
+	if (len > count)
+	{
+		len = count;
+	}
+
+	first = ring->mask + 1 - index;
+	if (first > len)
+	{
+		first = len;
+	}
+	memcpy(data, &ring->buf[index], first);
+	memcpy(&data[first], ring->buf, len - first);
+
+	// Data must be copied out before the producer may overwrite it
+	__DMB();
+	ring->tail = tail + len;
+
+	return len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Remove one byte (consumer side)
+  * @param	Pointer to ring
+  * @param	Pointer to store the byte
+  * @retval	1 if a byte was read, 0 if the ring is empty
+  ******************************************************************************
+  */
+uint8_t ring_get(ring_t* ring, uint8_t* byte)
+{
+	uint16_t tail = ring->tail;
+
+	if (tail == ring->head)
+	{
+		return 0;
+	}
+	*byte = ring->buf[tail & ring->mask];
+	__DMB();
+	ring->tail = tail + 1;
+
+	return 1;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the oldest bytes that are contiguous in storage (consumer
+  *					side), e.g. to hand them to DMA without copying
+  * @param	Pointer to ring
+  * @param	Pointer to store the data address
+  * @retval	Number of contiguous bytes, release them with ring_skip()
+  ******************************************************************************
+  */
+uint16_t ring_linear(const ring_t* ring, const uint8_t** data)
+{
+	uint16_t index = ring->tail & ring->mask;
+	uint16_t count = ring_count(ring);
+	uint16_t first = ring->mask + 1 - index;
+
+	*data = &ring->buf[index];
+
+	return (count < first) ? count : first;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Release bytes (consumer side)
+  * @param	Pointer to ring
+  * @param	Number of bytes, not more than ring_count()
+  * @retval	None
+  ******************************************************************************
+  */
+void ring_skip(ring_t* ring, uint16_t len)
+{
+	__DMB();
+	ring->tail += len;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file		ring.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Lock-free byte ring for one producer and one consumer, e.g. an
+	*					interrupt handler and the main loop. Only the producer writes
+	*					head and only the consumer writes tail, so neither side needs
+	*					to disable interrupts. Size must be a power of 2.
+  ******************************************************************************
+  */
+
+#ifndef __RING_H
+#define __RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint8_t* buf;
+	uint16_t mask;					// Size - 1
+	__IO uint16_t head;			// Free running write index, producer only
+	__IO uint16_t tail;			// Free running read index, consumer only
+} ring_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void ring_init(ring_t* ring, uint8_t* buf, uint16_t size);
+uint16_t ring_count(const ring_t* ring);
+uint16_t ring_free(const ring_t* ring);
+uint16_t ring_write(ring_t* ring, const uint8_t* data, uint16_t len);
+uint16_t ring_read(ring_t* ring, uint8_t* data, uint16_t len);
+uint8_t ring_get(ring_t* ring, uint8_t* byte);
+uint16_t ring_linear(const ring_t* ring, const uint8_t** data);
+void ring_skip(ring_t* ring, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
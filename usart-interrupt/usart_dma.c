@@ -0,0 +1,355 @@
+/**
+  ******************************************************************************
+  * @file		usart_dma.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "usart_dma.h"
+#include <string.h>
+
+/** Private variables ------------------------------------------------------- */
+static uint8_t rxDma[USART_DMA_RX_SIZE];
+// Position in rxDma up to which data has been moved to the RX ring
+static uint16_t rxDmaLast;
+static uint8_t rxStorage[USART_RX_RING_SIZE];
+static uint8_t txStorage[USART_TX_RING_SIZE];
+static ring_t rxRing;
+static ring_t txRing;
+// Bytes of the running TX DMA transfer, 0 when idle
+static __IO uint16_t txChunk;
+static usart_stats_t stats;
+
+/** Private function prototypes --------------------------------------------- */
+static void usart_rx_drain(void);
+static void usart_tx_kick(void);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize USART with RX and TX DMA
+  * @param	Baud rate
+  * @retval	None
+  ******************************************************************************
+  */
+void usart_init(uint32_t baud)
+{
+	// Initialization struct
+	USART_InitTypeDef USART_InitStruct;
+	GPIO_InitTypeDef GPIO_InitStruct;
+	NVIC_InitTypeDef NVIC_InitStruct;
+	
+	ring_init(&rxRing, rxStorage, sizeof(rxStorage));
+	ring_init(&txRing, txStorage, sizeof(txStorage));
+	
+	// Step 1: Initialize USART
+	RCC_APB1PeriphClockCmd(USARTx_RCC, ENABLE);
+	USART_InitStruct.USART_BaudRate = baud;
+	USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	USART_InitStruct.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+	USART_InitStruct.USART_Parity = USART_Parity_No;
+	USART_InitStruct.USART_StopBits = USART_StopBits_1;
+	USART_InitStruct.USART_WordLength = USART_WordLength_8b;
+	USART_Init(USARTx, &USART_InitStruct);
+	
+	// Step 2: Initialize GPIO for Tx and Rx pin
+	RCC_APB2PeriphClockCmd(USART_GPIO_RCC, ENABLE);
+	// Tx pin initialization as push-pull alternate function
+	GPIO_InitStruct.GPIO_Pin = USART_PIN_TX;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF_PP;
+	GPIO_InitStruct.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_Init(USART_GPIO, &GPIO_InitStruct);
+	// Rx pin initialization as input floating
+	GPIO_InitStruct.GPIO_Pin = USART_PIN_RX;
+	GPIO_InitStruct.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+	GPIO_Init(USART_GPIO, &GPIO_InitStruct);
+	
+	// Step 3: RX DMA runs forever in circular mode, TX DMA is started per
+	// chunk of the TX ring
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	USART_DMA_RX_CHANNEL->CCR = 0;
+	USART_DMA_RX_CHANNEL->CPAR = (uint32_t) &USARTx->DR;
+	USART_DMA_RX_CHANNEL->CMAR = (uint32_t) rxDma;
+	USART_DMA_RX_CHANNEL->CNDTR = USART_DMA_RX_SIZE;
+	USART_DMA_RX_CHANNEL->CCR = DMA_CCR1_PL_1 | DMA_CCR1_MINC | DMA_CCR1_CIRC | 
+		DMA_CCR1_HTIE | DMA_CCR1_TCIE | DMA_CCR1_EN;
+	USART_DMA_TX_CHANNEL->CCR = 0;
+	USART_DMA_TX_CHANNEL->CPAR = (uint32_t) &USARTx->DR;
+	
+	// Step 4: IDLE line and overrun interrupts, DMA requests
+	USARTx->CR1 |= USART_CR1_IDLEIE;
+	USARTx->CR3 |= USART_CR3_EIE | USART_CR3_DMAR | USART_CR3_DMAT;
+	USART_Cmd(USARTx, ENABLE);
+	
+	// Step 5: Initialize NVIC, all three handlers at the same priority so
+	// they never preempt each other
+	// Set NVIC prority group to group 4 
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+	// Set System Timer IRQ at higher priority
+	NVIC_SetPriority(SysTick_IRQn, 0);
+	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStruct.NVIC_IRQChannel = USART_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	NVIC_InitStruct.NVIC_IRQChannel = USART_DMA_RX_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+	NVIC_InitStruct.NVIC_IRQChannel = USART_DMA_TX_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Read received bytes
+  * @param	Buffer to store data
+  * @param	Max number of bytes
+  * @retval	Number of bytes read
+  ******************************************************************************
+  */
+uint16_t usart_read(uint8_t* data, uint16_t len)
+{
+	return ring_read(&rxRing, data, len);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Read one received byte
+  * @param	Pointer to store the byte
+  * @retval	1 if a byte was read, 0 if nothing was received
+  ******************************************************************************
+  */
+uint8_t usart_getc(uint8_t* c)
+{
+	return ring_get(&rxRing, c);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Queue bytes for sending, never blocks
+  * @param	Data
+  * @param	Number of bytes
+  * @retval	Number of bytes queued, less than len when the TX ring is full
+  ******************************************************************************
+  */
+uint16_t usart_write(const uint8_t* data, uint16_t len)
+{
+	len = ring_write(&txRing, data, len);
+	
+	// Start DMA unless the TX complete handler is going to do it
+	NVIC_DisableIRQ(USART_DMA_TX_IRQn);
+	usart_tx_kick();
+	NVIC_EnableIRQ(USART_DMA_TX_IRQn);
+	
+	return len;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Queue a string for sending, never blocks
+  * @param	Null terminated string
+  * @retval	Number of chars queued
+  ******************************************************************************
+  */
+uint16_t usart_puts(const char* s)
+{
+	return usart_write((const uint8_t*) s, strlen(s));
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get free space in the TX ring
+  * @param	None
+  * @retval	Byte count
+  ******************************************************************************
+  */
+uint16_t usart_tx_free()
+{
+	return ring_free(&txRing);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether queued data is still waiting or being sent
+  * @param	None
+  * @retval	1 if busy, otherwise 0
+  ******************************************************************************
+  */
+uint8_t usart_tx_busy()
+{
+	return (txChunk != 0) || (ring_count(&txRing) != 0);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the RX ring, for a parser that consumes it in place
+  * @param	None
+  * @retval	Pointer to RX ring, the caller is its only consumer
+  ******************************************************************************
+  */
+ring_t* usart_rx_ring()
+{
+	return &rxRing;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check whether the RX ring holds data
+  * @param	None
+  * @retval	1 if there is data to read, otherwise 0
+  ******************************************************************************
+  */
+uint8_t usart_rx_pending()
+{
+	return ring_count(&rxRing) != 0;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get RX and TX statistics
+  * @param	None
+  * @retval	Pointer to statistics
+  ******************************************************************************
+  */
+const usart_stats_t* usart_get_stats()
+{
+	return &stats;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	USART interrupt handler, IDLE line and overrun
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void USART_IRQHandler(void)
+{
+	uint16_t sr = USARTx->SR;
+	
+	if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE))
+	{
+		// Reading DR after SR clears the flags
+		(void) USARTx->DR;
+		if (sr & USART_SR_ORE)
+		{
+			stats.overruns++;
+		}
+		if (sr & USART_SR_IDLE)
+		{
+			// Line went quiet, pass on what has arrived so far
+			stats.idle_events++;
+			usart_rx_drain();
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	RX DMA half and full transfer interrupt handler
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void USART_DMA_RX_IRQHandler(void)
+{
+	if (DMA1->ISR & USART_DMA_RX_FLAGS)
+	{
+		DMA1->IFCR = USART_DMA_RX_CLEAR;
+		usart_rx_drain();
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	TX DMA transfer complete interrupt handler
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void USART_DMA_TX_IRQHandler(void)
+{
+	if (DMA1->ISR & USART_DMA_TX_TC_FLAG)
+	{
+		DMA1->IFCR = USART_DMA_TX_CLEAR;
+		USART_DMA_TX_CHANNEL->CCR &= ~DMA_CCR1_EN;
+		ring_skip(&txRing, txChunk);
+		stats.tx_bytes += txChunk;
+		txChunk = 0;
+		usart_tx_kick();
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Move bytes written by RX DMA since the last call into the RX ring
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void usart_rx_drain()
+{
+	uint16_t pos = USART_DMA_RX_SIZE - USART_DMA_RX_CHANNEL->CNDTR;
+	uint16_t len, written;
+	
+	if (pos == USART_DMA_RX_SIZE)
+	{
+		pos = 0;
+	}
+	if (pos == rxDmaLast)
+	{
+		return;
+	}
+	
+	if (pos > rxDmaLast)
+	{
+		len = pos - rxDmaLast;
+		written = ring_write(&rxRing, &rxDma[rxDmaLast], len);
+	}
+	else
+	{
+		// DMA wrapped around
+		len = USART_DMA_RX_SIZE - rxDmaLast;
+		written = ring_write(&rxRing, &rxDma[rxDmaLast], len);
+		len += pos;
+		written += ring_write(&rxRing, rxDma, pos);
+	}
+	rxDmaLast = pos;
+	stats.rx_bytes += written;
+	stats.rx_dropped += len - written;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Start TX DMA on the oldest contiguous part of the TX ring. Must
+  *					not be preempted by the TX DMA interrupt.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void usart_tx_kick()
+{
+	const uint8_t* data;
+	uint16_t len;
+	
+	if (txChunk)
+	{
+		return;
+	}
+	len = ring_linear(&txRing, &data);
+	if (len == 0)
+	{
+		return;
+	}
+	
+	txChunk = len;
+	USART_DMA_TX_CHANNEL->CMAR = (uint32_t) data;
+	USART_DMA_TX_CHANNEL->CNDTR = len;
+	USART_DMA_TX_CHANNEL->CCR = DMA_CCR1_PL_0 | DMA_CCR1_MINC | DMA_CCR1_DIR | 
+		DMA_CCR1_TCIE | DMA_CCR1_EN;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file		usart_dma.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		USART2 with DMA in both directions. RX DMA runs continuously
+	*					into a small circular buffer, which is drained into the RX ring
+	*					on half transfer, transfer complete and IDLE line interrupts.
+	*					TX DMA sends straight out of the TX ring. The main loop only
+	*					touches the rings, so reception never waits for it.
+  ******************************************************************************
+  */
+
+#ifndef __USART_DMA_H
+#define __USART_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_usart.h"
+#include "misc.h"
+#include "ring.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define USARTx_RCC							RCC_APB1Periph_USART2
+#define USARTx									USART2
+#define USART_GPIO_RCC					RCC_APB2Periph_GPIOA
+#define USART_GPIO							GPIOA
+#define USART_PIN_TX						GPIO_Pin_2
+#define USART_PIN_RX						GPIO_Pin_3
+#define USART_IRQn							USART2_IRQn
+#define USART_IRQHandler				USART2_IRQHandler
+
+// DMA channels and IRQs for USART2 (use channel 5/4 for USART1)
+#define USART_DMA_RX_CHANNEL		DMA1_Channel6
+#define USART_DMA_TX_CHANNEL		DMA1_Channel7
+#define USART_DMA_RX_FLAGS			(DMA_ISR_HTIF6 | DMA_ISR_TCIF6)
+#define USART_DMA_RX_CLEAR			DMA_IFCR_CGIF6
+#define USART_DMA_TX_TC_FLAG		DMA_ISR_TCIF7
+#define USART_DMA_TX_CLEAR			DMA_IFCR_CGIF7
+#define USART_DMA_RX_IRQn				DMA1_Channel6_IRQn
+#define USART_DMA_TX_IRQn				DMA1_Channel7_IRQn
+#define USART_DMA_RX_IRQHandler	DMA1_Channel6_IRQHandler
+#define USART_DMA_TX_IRQHandler	DMA1_Channel7_IRQHandler
+
+// Circular RX DMA buffer, drained at least every half of it
+#define USART_DMA_RX_SIZE				64
+// Ring sizes (power of 2), RX ring absorbs main loop latency
+#define USART_RX_RING_SIZE			512
+#define USART_TX_RING_SIZE			512
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct
+{
+	uint32_t rx_bytes;				// Bytes moved into the RX ring
+	uint32_t rx_dropped;			// Bytes lost because the RX ring was full
+	uint32_t overruns;				// USART overrun errors (DMA too late)
+	uint32_t idle_events;			// IDLE line detections (end of a burst)
+	uint32_t tx_bytes;				// Bytes sent by DMA
+} usart_stats_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void usart_init(uint32_t baud);
+uint16_t usart_read(uint8_t* data, uint16_t len);
+uint8_t usart_getc(uint8_t* c);
+uint16_t usart_write(const uint8_t* data, uint16_t len);
+uint16_t usart_puts(const char* s);
+uint16_t usart_tx_free(void);
+uint8_t usart_tx_busy(void);
+ring_t* usart_rx_ring(void);
+uint8_t usart_rx_pending(void);
+const usart_stats_t* usart_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -15,6 +15,8 @@ uint16_t USART2_GetChar(void);
 #define BUF_SIZE	16
 char buf[BUF_SIZE];
 int i = 0;
+// Set when a line did not fit into the buffer
+uint8_t overflow = 0;
 
 int main(void)
 {
@@ -32,8 +34,9 @@ int main(void)
 		// Read chars until newline
 		if (c != '\n')
 		{
-			// Concat char to buffer
-			// If maximum buffer size is reached, then reset i to 0
+			// Concat char to buffer, the last byte is kept for the null
+			// terminator. Chars that do not fit are dropped and the line
+			// is flagged as truncated.
 			if (i < BUF_SIZE - 1)
 			{
 				buf[i] = c;
@@ -41,8 +44,7 @@ int main(void)
 			}
 			else
 			{
-				buf[i] = c;
-				i = 0;
+				overflow = 1;
 			}
 		}
 		else
@@ -50,6 +52,11 @@ int main(void)
 			// Display received string to LCD
 			lcd16x2_clrscr();
 			lcd16x2_puts(buf);
+			if (overflow)
+			{
+				lcd16x2_gotoxy(0, 1);
+				lcd16x2_puts("(truncated)");
+			}
 			
 			// Echo received string to USART2
 			USART2_PutString(buf);
@@ -58,6 +65,7 @@ int main(void)
 			// Clear buffer
 			memset(&buf[0], 0, sizeof(buf));
 			i = 0;
+			overflow = 0;
 		}
 	}
 }
@@ -0,0 +1,248 @@
+/**
+  ******************************************************************************
+  * @file		delay.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		10 January 2016
+	* @note		Busy-wait delays are timed with the DWT cycle counter, so they
+	*					need no interrupt. SysTick only runs at 1 kHz to extend the
+	*					32-bit cycle counter into a 64-bit monotonic clock.
+	*					DelayIdle() and DelaySleepMs() stop the core with WFI and
+	*					suppress SysTick while asleep, then correct the timebase.
+	*					DelayIdleUntil() checks a wakeup condition with interrupts
+	*					masked, so an interrupt that sets it just before WFI is
+	*					not missed.
+  ******************************************************************************
+  */
+
+#include "delay.h"
+
+// Core clock cycles per us and per ms (one SysTick period)
+static uint32_t cyclesPerUs;
+static uint32_t cyclesPerMs;
+// Max ms SysTick can be suppressed for (24-bit reload register)
+static uint32_t maxIdleMs;
+// Cycles spent asleep and start of the current sleep statistics window
+static uint64_t sleepCycles;
+static uint64_t sleepWindowStart;
+// Upper 32 bits of the 64-bit cycle counter
+static __IO uint32_t cyclesHigh;
+// Cycle counter value at last SysTick, used to detect wrap around
+static __IO uint32_t cyclesLast;
+// Milliseconds since DelayInit()
+static __IO uint32_t msTicks;
+
+// SysTick_Handler function will be called every 1 ms
+void SysTick_Handler()
+{
+	uint32_t now = DWT->CYCCNT;
+
+	// Cycle counter wraps every 2^32 cycles (59.6 s at 72 MHz)
+	if (now < cyclesLast)
+	{
+		cyclesHigh++;
+	}
+	cyclesLast = now;
+	msTicks++;
+}
+
+void DelayInit()
+{
+	// Update SystemCoreClock value
+	SystemCoreClockUpdate();
+	cyclesPerUs = SystemCoreClock / 1000000;
+	cyclesPerMs = SystemCoreClock / 1000;
+	maxIdleMs = SysTick_LOAD_RELOAD_Msk / cyclesPerMs;
+
+	// Enable DWT cycle counter
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	// Configure the SysTick timer to overflow every 1 ms
+	SysTick_Config(SystemCoreClock / 1000);
+}
+
+void DelayUs(uint32_t us)
+{
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles = us * cyclesPerUs;
+
+	// Unsigned subtraction handles cycle counter wrap around
+	while ((DWT->CYCCNT - start) < cycles);
+}
+
+void DelayMs(uint32_t ms)
+{
+	// Wait until ms reach zero
+	while (ms--)
+	{
+		// Delay 1ms
+		DelayUs(1000);
+	}
+}
+
+uint32_t DelayGetCycles()
+{
+	return DWT->CYCCNT;
+}
+
+uint64_t DelayGetCycles64()
+{
+	uint32_t high, last, now;
+
+	// Retry if SysTick updated the upper half while reading
+	do
+	{
+		high = cyclesHigh;
+		last = cyclesLast;
+		now = DWT->CYCCNT;
+	} while (high != cyclesHigh);
+
+	// Counter wrapped after the last SysTick but before it was handled
+	if (now < last)
+	{
+		high++;
+	}
+
+	return ((uint64_t)high << 32) | now;
+}
+
+uint64_t DelayGetUs()
+{
+	return DelayGetCycles64() / cyclesPerUs;
+}
+
+uint32_t DelayGetMs()
+{
+	return msTicks;
+}
+
+void DelayIdle(uint32_t ms)
+{
+	DelayIdleUntil(0, ms);
+}
+
+void DelayIdleUntil(uint8_t (*ready)(void), uint32_t ms)
+{
+	uint32_t reload, ctrl, elapsed, completed, slept, awake;
+	uint32_t start;
+
+	if (ms == 0)
+	{
+		return;
+	}
+	if (ms > maxIdleMs)
+	{
+		ms = maxIdleMs;
+	}
+
+	// WFI still wakes up on a pending interrupt while PRIMASK is set, the
+	// handler then runs after the timebase has been corrected
+	__disable_irq();
+
+	// Check the condition only now, an interrupt that made it true after
+	// the caller last looked would otherwise be slept through
+	if (ready && ready())
+	{
+		__enable_irq();
+		return;
+	}
+
+	// Stop SysTick and stretch the current tick to cover ms ticks.
+	// -1 because we are already part way through the current tick.
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+	reload = SysTick->VAL + ((ms - 1) * cyclesPerMs);
+	if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || (reload < cyclesPerUs))
+	{
+		// Tick pending or about to happen, not worth sleeping
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+		__enable_irq();
+		return;
+	}
+	SysTick->LOAD = reload;
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	start = DWT->CYCCNT;
+
+	__DSB();
+	__WFI();
+	__ISB();
+
+	// Stop SysTick to get a stable count, reading CTRL clears COUNTFLAG
+	ctrl = SysTick->CTRL;
+	SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+	if (ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+	{
+		// Woken by the stretched tick, its interrupt is pending and will
+		// count the last ms. Finish the tick it has already started.
+		elapsed = reload - SysTick->VAL;
+		slept = reload + 1 + elapsed;
+		completed = ms - 1;
+		SysTick->LOAD = (elapsed < cyclesPerMs) ? 
+			(cyclesPerMs - 1 - elapsed) : (cyclesPerMs - 1);
+	}
+	else
+	{
+		// Woken by another interrupt, count whole ticks since the boundary
+		// of the tick we went to sleep in
+		slept = reload - SysTick->VAL;
+		elapsed = (ms * cyclesPerMs) - SysTick->VAL;
+		completed = elapsed / cyclesPerMs;
+		SysTick->LOAD = ((completed + 1) * cyclesPerMs) - elapsed;
+	}
+
+	// Run the rest of this tick, normal period is loaded on the next reload
+	SysTick->VAL = 0;
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+	SysTick->LOAD = cyclesPerMs - 1;
+	msTicks += completed;
+	sleepCycles += slept;
+
+	// The cycle counter may not run while the core is asleep,
+	// move it forward by the time SysTick measured
+	awake = DWT->CYCCNT - start;
+	if (awake < slept)
+	{
+		DWT->CYCCNT = start + slept;
+	}
+	if (DWT->CYCCNT < cyclesLast)
+	{
+		cyclesHigh++;
+		cyclesLast = DWT->CYCCNT;
+	}
+
+	__enable_irq();
+}
+
+void DelaySleepMs(uint32_t ms)
+{
+	uint32_t start = DelayGetMs();
+	uint32_t elapsed;
+
+	// Sleep again after every wakeup by other interrupts
+	while ((elapsed = DelayGetMs() - start) < ms)
+	{
+		DelayIdle(ms - elapsed);
+	}
+}
+
+uint16_t DelayGetSleepPermille()
+{
+	uint64_t now = DelayGetCycles64();
+	uint64_t window = now - sleepWindowStart;
+	uint16_t permille = 0;
+
+	if (window)
+	{
+		permille = (uint16_t)((sleepCycles * 1000) / window);
+	}
+
+	// Start a new window
+	sleepCycles = 0;
+	sleepWindowStart = now;
+
+	return permille;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
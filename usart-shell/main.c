@@ -0,0 +1,87 @@
+#include "stm32f10x.h"
+#include "stm32f10x_rcc.h"
+#include "stm32f10x_gpio.h"
+#include "stm32f10x_usart.h"
+#include "delay.h"
+#include "lcd16x2.h"
+#include "usart_dma.h"
+#include "stats.h"
+#include "shell.h"
+#include "fmt.h"
+
+// 36 MHz APB1 clock divides to exactly 1 Mbaud
+#define USART_BAUD	1000000
+
+void cmd_load(uint8_t argc, char** argv);
+void cmd_uptime(uint8_t argc, char** argv);
+
+const shell_command_t commands[] =
+{
+	{ "help", "list commands", shell_cmd_help },
+	{ "stats", "[prefix] dump counters and histograms", shell_cmd_stats },
+	{ "hist", "<name> show histogram bins", shell_cmd_hist },
+	{ "reset", "[prefix] clear histograms", shell_cmd_reset },
+	{ "load", "CPU load since last call", cmd_load },
+	{ "uptime", "time since reset", cmd_uptime },
+};
+
+// Main loop diagnostics
+uint32_t loops;
+stats_counter_t loopsCounter;
+stats_hist_t awakeHist;
+
+int main(void)
+{
+	uint32_t start;
+	
+	DelayInit();
+	lcd16x2_init(LCD16X2_DISPLAY_ON_CURSOR_OFF_BLINK_OFF);
+	lcd16x2_puts("USART Shell\n1 Mbaud");
+	
+	// Initialize USART with RX and TX DMA, then the shell on top of it
+	usart_init(USART_BAUD);
+	stats_counter_register(&loopsCounter, "main.loops", &loops);
+	stats_hist_register(&awakeHist, "main.awake", "cyc");
+	shell_init(commands, sizeof(commands) / sizeof(commands[0]));
+	
+	while (1)
+	{
+		// Time spent awake per main loop pass
+		start = DelayGetCycles();
+		shell_process();
+		loops++;
+		stats_hist_add(&awakeHist, DelayGetCycles() - start);
+		
+		// Nothing to do until a byte arrives
+		DelayIdleUntil(usart_rx_pending, DELAY_IDLE_FOREVER);
+	}
+}
+
+void cmd_load(uint8_t argc, char** argv)
+{
+	char buf[16];
+	uint16_t permille = 1000 - DelayGetSleepPermille();
+	uint8_t n;
+	
+	// Awake time since the previous call
+	n = fmt_str(buf, "cpu ", 0);
+	n += fmt_dec(&buf[n], permille / 10, 0, FMT_PAD_SPACE);
+	buf[n++] = '.';
+	buf[n++] = '0' + (permille % 10);
+	n += fmt_str(&buf[n], " %\r\n", 0);
+	shell_write(buf, n);
+}
+
+void cmd_uptime(uint8_t argc, char** argv)
+{
+	char buf[16];
+	uint32_t s = DelayGetMs() / 1000;
+	uint8_t n;
+	
+	n = fmt_dec(buf, s / 86400, 0, FMT_PAD_SPACE);
+	n += fmt_str(&buf[n], "d ", 0);
+	n += fmt_time(&buf[n], (s / 3600) % 24, (s / 60) % 60, s % 60);
+	buf[n++] = '\r';
+	buf[n++] = '\n';
+	shell_write(buf, n);
+}
@@ -0,0 +1,386 @@
+/**
+  ******************************************************************************
+  * @file		shell.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "shell.h"
+#include <string.h>
+
+/** Private defines --------------------------------------------------------- */
+#define KEY_CTRL_C			0x03
+#define KEY_BACKSPACE		0x08
+#define KEY_CTRL_U			0x15
+#define KEY_DELETE			0x7F
+// Width of the name column in dumps
+#define NAME_WIDTH			20
+
+/** Private variables ------------------------------------------------------- */
+static const shell_command_t* commandTable;
+static uint8_t commandCount;
+static char line[SHELL_LINE_SIZE];
+static uint8_t lineLen;
+// Last char was CR, so a following LF does not run the line again
+static uint8_t lastCr;
+
+/** Private function prototypes --------------------------------------------- */
+static void shell_execute(void);
+static void shell_prompt(void);
+static uint8_t shell_match(const char* name, uint8_t argc, char** argv);
+static stats_hist_t* shell_find_hist(const char* name);
+static void shell_hist_summary(stats_hist_t* hist);
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Initialize shell and print the prompt, usart_init() must be
+  *					called first
+  * @param	Command table, must stay valid
+  * @param	Number of commands
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_init(const shell_command_t* commands, uint8_t count)
+{
+	commandTable = commands;
+	commandCount = count;
+	lineLen = 0;
+	shell_puts("\r\n");
+	shell_prompt();
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Handle received chars and run complete lines. Call this from
+  *					the main loop.
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_process()
+{
+	uint8_t c;
+
+	while (usart_getc(&c))
+	{
+		if ((c == '\r') || ((c == '\n') && !lastCr))
+		{
+			shell_puts("\r\n");
+			shell_execute();
+			lineLen = 0;
+			shell_prompt();
+		}
+		else if ((c == KEY_BACKSPACE) || (c == KEY_DELETE))
+		{
+			if (lineLen)
+			{
+				lineLen--;
+				shell_puts("\b \b");
+			}
+		}
+		else if (c == KEY_CTRL_U)
+		{
+			while (lineLen)
+			{
+				lineLen--;
+				shell_puts("\b \b");
+			}
+		}
+		else if (c == KEY_CTRL_C)
+		{
+			shell_puts("^C\r\n");
+			lineLen = 0;
+			shell_prompt();
+		}
+		else if ((c >= ' ') && (c < KEY_DELETE) && 
+			(lineLen < (SHELL_LINE_SIZE - 1)))
+		{
+			// Printable and fits, echo it. Tabs and other control chars
+			// are ignored.
+			line[lineLen++] = c;
+			shell_write((const char*) &c, 1);
+		}
+		lastCr = (c == '\r');
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Send data, waits while the TX ring is full
+  * @param	Data
+  * @param	Number of bytes
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_write(const char* data, uint16_t len)
+{
+	uint16_t n;
+
+	while (len)
+	{
+		n = usart_write((const uint8_t*) data, len);
+		data += n;
+		len -= n;
+		if (len)
+		{
+			// TX DMA interrupt wakes up when a chunk is sent
+			DelayIdle(1);
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Send a string, waits while the TX ring is full
+  * @param	Null terminated string
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_puts(const char* s)
+{
+	shell_write(s, strlen(s));
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Command "help": list commands
+  * @param	Argument count
+  * @param	Arguments
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_cmd_help(uint8_t argc, char** argv)
+{
+	char buf[NAME_WIDTH];
+	uint8_t i;
+
+	for (i = 0; i < commandCount; i++)
+	{
+		shell_write(buf, fmt_str(buf, commandTable[i].name, 8));
+		shell_puts(commandTable[i].help);
+		shell_puts("\r\n");
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Command "stats [prefix]": dump counters and histogram summaries
+  * @param	Argument count
+  * @param	Arguments, optional name prefix filter
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_cmd_stats(uint8_t argc, char** argv)
+{
+	char buf[NAME_WIDTH + FMT_DEC_MAX + 2];
+	stats_counter_t* counter;
+	stats_hist_t* hist;
+	uint8_t n;
+
+	for (counter = stats_counters(); counter; counter = counter->next)
+	{
+		if (shell_match(counter->name, argc, argv))
+		{
+			n = fmt_str(buf, counter->name, NAME_WIDTH);
+			n += fmt_dec(&buf[n], *counter->value, FMT_DEC_MAX, FMT_PAD_SPACE);
+			buf[n++] = '\r';
+			buf[n++] = '\n';
+			shell_write(buf, n);
+		}
+	}
+	for (hist = stats_hists(); hist; hist = hist->next)
+	{
+		if (shell_match(hist->name, argc, argv))
+		{
+			shell_hist_summary(hist);
+		}
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Command "hist name": print the bins of a histogram
+  * @param	Argument count
+  * @param	Arguments, histogram name
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_cmd_hist(uint8_t argc, char** argv)
+{
+	char buf[32];
+	stats_hist_t* hist;
+	uint8_t i, n;
+
+	if ((argc < 2) || !(hist = shell_find_hist(argv[1])))
+	{
+		shell_puts("usage: hist <name>\r\n");
+		return;
+	}
+
+	shell_hist_summary(hist);
+	for (i = 0; i < STATS_BINS; i++)
+	{
+		if (hist->bins[i] == 0)
+		{
+			continue;
+		}
+		// Bin i holds values below 2^i
+		n = fmt_str(buf, (i == STATS_BINS - 1) ? "  >=" : "  < ", 4);
+		n += fmt_dec(&buf[n], (i == STATS_BINS - 1) ? 
+			(1UL << (i - 1)) : (1UL << i), 6, FMT_PAD_SPACE);
+		n += fmt_dec(&buf[n], hist->bins[i], FMT_DEC_MAX, FMT_PAD_SPACE);
+		buf[n++] = '\r';
+		buf[n++] = '\n';
+		shell_write(buf, n);
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Command "reset [prefix]": clear histograms
+  * @param	Argument count
+  * @param	Arguments, optional name prefix filter
+  * @retval	None
+  ******************************************************************************
+  */
+void shell_cmd_reset(uint8_t argc, char** argv)
+{
+	stats_hist_t* hist;
+
+	for (hist = stats_hists(); hist; hist = hist->next)
+	{
+		if (shell_match(hist->name, argc, argv))
+		{
+			stats_hist_reset(hist);
+		}
+	}
+}
+
+/** Private functions ------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Split the line into arguments in place and run the command
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void shell_execute()
+{
+	char* argv[SHELL_MAX_ARGS];
+	uint8_t argc = 0;
+	uint8_t i;
+	char* p = line;
+
+	line[lineLen] = '\0';
+	while (*p && (argc < SHELL_MAX_ARGS))
+	{
+		while (*p == ' ')
+		{
+			*p++ = '\0';
+		}
+		if (*p)
+		{
+			argv[argc++] = p;
+			while (*p && (*p != ' '))
+			{
+				p++;
+			}
+		}
+	}
+	if (argc == 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < commandCount; i++)
+	{
+		if (strcmp(argv[0], commandTable[i].name) == 0)
+		{
+			commandTable[i].handler(argc, argv);
+			return;
+		}
+	}
+	shell_puts("unknown command, try help\r\n");
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Print the prompt
+  * @param	None
+  * @retval	None
+  ******************************************************************************
+  */
+static void shell_prompt()
+{
+	shell_puts(SHELL_PROMPT);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Check a registry name against the optional prefix argument
+  * @param	Name
+  * @param	Argument count
+  * @param	Arguments, argv[1] is the prefix
+  * @retval	1 if selected, otherwise 0
+  ******************************************************************************
+  */
+static uint8_t shell_match(const char* name, uint8_t argc, char** argv)
+{
+	return (argc < 2) || (strncmp(name, argv[1], strlen(argv[1])) == 0);
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Find a histogram by name
+  * @param	Name
+  * @retval	Histogram, 0 if not found
+  ******************************************************************************
+  */
+static stats_hist_t* shell_find_hist(const char* name)
+{
+	stats_hist_t* hist;
+
+	for (hist = stats_hists(); hist; hist = hist->next)
+	{
+		if (strcmp(hist->name, name) == 0)
+		{
+			break;
+		}
+	}
+
+	return hist;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Print count, average and max of a histogram on one line
+  * @param	Histogram
+  * @retval	None
+  ******************************************************************************
+  */
+static void shell_hist_summary(stats_hist_t* hist)
+{
+	char buf[NAME_WIDTH + 3 * (FMT_DEC_MAX + 5) + 8];
+	uint32_t count = hist->count;
+	uint8_t n;
+
+	n = fmt_str(buf, hist->name, NAME_WIDTH);
+	n += fmt_str(&buf[n], " n=", 0);
+	n += fmt_dec(&buf[n], count, 0, FMT_PAD_SPACE);
+	n += fmt_str(&buf[n], " avg=", 0);
+	n += fmt_dec(&buf[n], count ? (uint32_t)(hist->sum / count) : 0, 0, 
+		FMT_PAD_SPACE);
+	n += fmt_str(&buf[n], " max=", 0);
+	n += fmt_dec(&buf[n], hist->max, 0, FMT_PAD_SPACE);
+	buf[n++] = ' ';
+	n += fmt_str(&buf[n], hist->unit, 0);
+	buf[n++] = '\r';
+	buf[n++] = '\n';
+	shell_write(buf, n);
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file		shell.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Line based command shell on the DMA USART. Commands come from
+	*					a constant table, arguments are split in place in the line
+	*					buffer, nothing is allocated. Editing keys: backspace, Ctrl-U
+	*					(erase line) and Ctrl-C (cancel). Output blocks the main loop
+	*					while the TX ring is full, never an interrupt handler.
+  ******************************************************************************
+  */
+
+#ifndef __SHELL_H
+#define __SHELL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "delay.h"
+#include "usart_dma.h"
+#include "stats.h"
+#include "fmt.h"
+
+/** Defines ----------------------------------------------------------------- */
+#define SHELL_LINE_SIZE		48
+#define SHELL_MAX_ARGS		4
+#define SHELL_PROMPT			"> "
+
+/** Typedefs ---------------------------------------------------------------- */
+// argv[0] is the command name
+typedef void (*shell_handler_t)(uint8_t argc, char** argv);
+
+typedef struct
+{
+	const char* name;
+	const char* help;
+	shell_handler_t handler;
+} shell_command_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void shell_init(const shell_command_t* commands, uint8_t count);
+void shell_process(void);
+void shell_write(const char* data, uint16_t len);
+void shell_puts(const char* s);
+// Built-in commands for the command table
+void shell_cmd_help(uint8_t argc, char** argv);
+void shell_cmd_stats(uint8_t argc, char** argv);
+void shell_cmd_hist(uint8_t argc, char** argv);
+void shell_cmd_reset(uint8_t argc, char** argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
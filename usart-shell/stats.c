@@ -0,0 +1,137 @@
+/**
+  ******************************************************************************
+  * @file		stats.c
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+  ******************************************************************************
+  */
+
+/** Includes ---------------------------------------------------------------- */
+#include "stats.h"
+
+/** Private variables ------------------------------------------------------- */
+// Registry lists in registration order
+static stats_counter_t* counterHead;
+static stats_counter_t** counterTail = &counterHead;
+static stats_hist_t* histHead;
+static stats_hist_t** histTail = &histHead;
+
+/** Public functions -------------------------------------------------------- */
+/**
+  ******************************************************************************
+  *	@brief	Register a counter, call once from the main loop or init
+  * @param	Counter object with static storage
+  * @param	Name shown by the shell, e.g. "usart.rx_bytes"
+  * @param	Variable holding the count
+  * @retval	None
+  ******************************************************************************
+  */
+void stats_counter_register(stats_counter_t* counter, const char* name, 
+	const __IO uint32_t* value)
+{
+	counter->name = name;
+	counter->value = value;
+	counter->next = 0;
+	*counterTail = counter;
+	counterTail = &counter->next;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Register a histogram, call once from the main loop or init
+  * @param	Histogram object with static storage
+  * @param	Name shown by the shell
+  * @param	Unit of the values, e.g. "cyc" or "B"
+  * @retval	None
+  ******************************************************************************
+  */
+void stats_hist_register(stats_hist_t* hist, const char* name, 
+	const char* unit)
+{
+	hist->name = name;
+	hist->unit = unit;
+	stats_hist_reset(hist);
+	hist->next = 0;
+	*histTail = hist;
+	histTail = &hist->next;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Add a sample, from one writer only
+  * @param	Histogram
+  * @param	Value
+  * @retval	None
+  ******************************************************************************
+  */
+void stats_hist_add(stats_hist_t* hist, uint32_t value)
+{
+	// Bin is the bit length of the value (CLZ is a single instruction)
+	uint8_t bin = 32 - __CLZ(value);
+
+	if (bin >= STATS_BINS)
+	{
+		bin = STATS_BINS - 1;
+	}
+	hist->bins[bin]++;
+	hist->count++;
+	hist->sum += value;
+	if (value > hist->max)
+	{
+		hist->max = value;
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Clear a histogram. Interrupts are masked while clearing, so a
+  *					writer in an interrupt handler never sees it half cleared.
+  * @param	Histogram
+  * @retval	None
+  ******************************************************************************
+  */
+void stats_hist_reset(stats_hist_t* hist)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint8_t i;
+
+	__disable_irq();
+	hist->count = 0;
+	hist->max = 0;
+	hist->sum = 0;
+	for (i = 0; i < STATS_BINS; i++)
+	{
+		hist->bins[i] = 0;
+	}
+	if (!primask)
+	{
+		__enable_irq();
+	}
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the first registered counter
+  * @param	None
+  * @retval	Counter, follow next for the others (0 = none)
+  ******************************************************************************
+  */
+stats_counter_t* stats_counters()
+{
+	return counterHead;
+}
+
+/**
+  ******************************************************************************
+  *	@brief	Get the first registered histogram
+  * @param	None
+  * @retval	Histogram, follow next for the others (0 = none)
+  ******************************************************************************
+  */
+stats_hist_t* stats_hists()
+{
+	return histHead;
+}
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/
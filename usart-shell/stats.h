@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file		stats.h
+  * @author	Yohanes Erwin Setiawan
+  * @date		18 October 2026
+	* @note		Registry of named counters and histograms for runtime
+	*					diagnostics. Modules own the objects (static storage, no heap)
+	*					and register them once, the shell walks the registry. A counter
+	*					points at a variable the module already keeps. Histograms are
+	*					updated by a single writer, e.g. one interrupt handler, and
+	*					read without locking, so a dump may be off by one sample.
+	*					stats_hist_reset() masks interrupts, so it may be called from
+	*					the main loop for a histogram an interrupt handler writes.
+  ******************************************************************************
+  */
+
+#ifndef __STATS_H
+#define __STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Includes ---------------------------------------------------------------- */
+#include "stm32f10x.h"
+#include "delay.h"
+
+/** Defines ----------------------------------------------------------------- */
+// Histogram bins: bin 0 counts value 0, bin n counts 2^(n-1) to 2^n - 1,
+// the last bin everything above
+#define STATS_BINS			16
+
+// Time an interrupt handler (or any section) into a histogram
+#define STATS_TIME_BEGIN()		uint32_t statsStart = DelayGetCycles()
+#define STATS_TIME_END(hist)	stats_hist_add((hist), DelayGetCycles() - statsStart)
+
+/** Typedefs ---------------------------------------------------------------- */
+typedef struct stats_counter
+{
+	const char* name;
+	const __IO uint32_t* value;
+	struct stats_counter* next;		// Registry link, owned by stats
+} stats_counter_t;
+
+typedef struct stats_hist
+{
+	const char* name;
+	const char* unit;
+	__IO uint32_t count;
+	__IO uint32_t max;
+	__IO uint64_t sum;
+	__IO uint32_t bins[STATS_BINS];
+	struct stats_hist* next;			// Registry link, owned by stats
+} stats_hist_t;
+
+/** Public function prototypes ---------------------------------------------- */
+void stats_counter_register(stats_counter_t* counter, const char* name, 
+	const __IO uint32_t* value);
+void stats_hist_register(stats_hist_t* hist, const char* name, 
+	const char* unit);
+void stats_hist_add(stats_hist_t* hist, uint32_t value);
+void stats_hist_reset(stats_hist_t* hist);
+stats_counter_t* stats_counters(void);
+stats_hist_t* stats_hists(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/********************************* END OF FILE ********************************/
+/******************************************************************************/